@@ -1,47 +1,145 @@
 #pragma once
 #include <random>
 #include <cstdint>
+#include <string>
+#include <sstream>
 
-class Rand {
+//
+// xoshiro128++ (Blackman & Vigna)
+// 状態は16バイトだけなので，スレッドごとにソルバを持っても軽い．
+// 種は splitmix64 で状態に広げる．同じ種からはどの環境でも同じ列になる
+//
+class Xoshiro128pp {
 private:
-    std::mt19937 mt;            //32ビット版メルセンヌ・ツイスタ
-    std::random_device rd;      //非決定論的な乱数
+    std::uint32_t s[4];
+
+    static std::uint32_t rotl(const std::uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
 
 public:
+    typedef std::uint32_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    Xoshiro128pp() { seed(0); }
+
+    void seed(std::uint64_t seed_) {
+        for (int i = 0; i < 4; i += 2) {
+            // splitmix64
+            std::uint64_t z = (seed_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            s[i] = (std::uint32_t)z;
+            s[i + 1] = (std::uint32_t)(z >> 32);
+        }
+    }
+
+    result_type operator()() {
+        const std::uint32_t result = rotl(s[0] + s[3], 7) + s[0];
+        const std::uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    // 状態の入出力（std::mt19937 と同じく空白区切りの数）
+    friend std::ostream& operator<<(std::ostream& os, const Xoshiro128pp& x) {
+        return os << x.s[0] << ' ' << x.s[1] << ' ' << x.s[2] << ' ' << x.s[3];
+    }
+    friend std::istream& operator>>(std::istream& is, Xoshiro128pp& x) {
+        return is >> x.s[0] >> x.s[1] >> x.s[2] >> x.s[3];
+    }
+};
+
+
+//
+// 乱数のクラス．Engine は32ビットの一様乱数を返す生成器
+// 範囲の乱数は Lemire の方法（掛け算と棄却）で偏りなく作るので，
+// 標準ライブラリの分布クラスと違い，どの環境でも同じ結果になる
+//
+template <typename Engine>
+class RandT {
+private:
+    Engine mt;
+
+    // 0～range-1 の一様分布乱数 (range == 0 なら 32ビット全体)
+    std::uint32_t bounded(const std::uint32_t range) {
+        if (range == 0) return mt();
+        std::uint64_t m = (std::uint64_t)mt() * range;
+        std::uint32_t l = (std::uint32_t)m;
+        if (l < range) {
+            const std::uint32_t t = (0u - range) % range;
+            while (l < t) {
+                m = (std::uint64_t)mt() * range;
+                l = (std::uint32_t)m;
+            }
+        }
+        return (std::uint32_t)(m >> 32);
+    }
+
+public:
+    // 既定の種（std::mt19937 の既定値と同じ）
+    static const std::uint_fast32_t default_seed = 5489u;
+
     // コンストラクタ(初期化)
-    Rand() { mt.seed(rd()); }
+    // 固定の種で始めるので，作るのは軽く結果も再現できる．
+    // 実行ごとに変えたいときは seed() を呼ぶ
+    RandT() { seed(default_seed); }
 
-    //初期値
+    //初期値（std::random_device による非決定論的な種）
     void seed() {
+        std::random_device rd;      //非決定論的な乱数
         mt.seed(rd());
     }
     void seed(const std::uint_fast32_t seed_) {
         mt.seed(seed_);
     }
 
+    //状態の保存と復元（チェックポイント用）
+    std::string state() const {
+        std::ostringstream os;
+        os << mt;
+        return os.str();
+    }
+    void set_state(const std::string& st) {
+        std::istringstream is(st);
+        is >> mt;
+    }
+
     //通常の乱数
     std::uint_fast32_t operator()() {
         return mt();
     }
     //0～最大値-1 (余りの範囲の一様分布乱数)
     std::int_fast32_t operator()(const std::int_fast32_t max_) {
-        std::uniform_int_distribution<> uid(0, ((max_ > 0) ? (std::int_fast32_t)max_ - 1 : 0));
-        return uid(mt);
+        return (max_ > 0) ? (std::int_fast32_t)bounded((std::uint32_t)max_) : 0;
     }
     //最小値～最大値
     std::int_fast32_t operator()(const std::int_fast32_t min_, const std::int_fast32_t max_) {
-        std::uniform_int_distribution<> uid((min_ <= max_) ? min_ : max_, (min_ <= max_) ? max_ : min_);
-        return uid(mt);
+        const std::int_fast32_t lo = (min_ <= max_) ? min_ : max_;
+        const std::int_fast32_t hi = (min_ <= max_) ? max_ : min_;
+        return lo + (std::int_fast32_t)bounded((std::uint32_t)(hi - lo) + 1);
     }
     //確率
     bool randBool(const double probability_) {
-        std::bernoulli_distribution uid(probability_);
-        return uid(mt);
+        return mt() * (1.0 / 4294967296.0) < probability_;
     }
     bool randBool() {
-        std::uniform_int_distribution<> uid(0, 1);
-        return ((uid(mt)) ? true : false);
+        return (mt() >> 31) != 0;
     }
 };
 
+// 既定は xoshiro128++．-DRAND_MT19937 でメルセンヌ・ツイスタにする
+#ifdef RAND_MT19937
+typedef RandT<std::mt19937> Rand;       //32ビット版メルセンヌ・ツイスタ
+#else
+typedef RandT<Xoshiro128pp> Rand;
+#endif
+
 //static thread_local Rand rnd;
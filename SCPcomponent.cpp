@@ -0,0 +1,76 @@
+#include "SCPcomponent.hpp"
+#include <numeric>
+using namespace std;
+
+
+// 行の union-find（大きさでつなぎ，find で経路を半分にする）
+class RowUnion
+{
+public:
+  RowUnion(int n) : parent(n), size(n, 1) { iota(parent.begin(), parent.end(), 0); }
+
+  int find(int x)
+  {
+    while (parent[x] != x)
+    {
+      parent[x] = parent[parent[x]];
+      x = parent[x];
+    }
+    return x;
+  }
+
+  void unite(int a, int b)
+  {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (size[a] < size[b]) swap(a, b);
+    parent[b] = a;
+    size[a] += size[b];
+  }
+
+private:
+  vector<int> parent;
+  vector<int> size;
+};
+
+
+// 連結成分に分ける
+// 列の行をすべて最初の行とつなぎ，行の代表ごとに成分の番号を付ける
+vector<SCPcomponent> find_components(const SCPinstance &inst, vector<int> &colIndex)
+{
+  RowUnion uf(inst.numRows);
+  for (int j = 0; j < inst.numColumns; j++)
+  {
+    SCPlists::Range R = inst.ColEntries[j];
+    for (int r : R) uf.unite(R[0], r);
+  }
+
+  // 行の番号の順に見るので，成分は最小の行番号の順になる
+  vector<int> compOf(inst.numRows, -1);         // 代表の行 -> 成分の番号
+  vector<SCPcomponent> comps;
+  for (int i = 0; i < inst.numRows; i++)
+  {
+    int root = uf.find(i);
+    if (compOf[root] < 0)
+    {
+      compOf[root] = comps.size();
+      comps.push_back(SCPcomponent());
+    }
+    comps[compOf[root]].rows.push_back(i);
+  }
+
+  colIndex.assign(inst.numColumns, -1);
+  for (int j = 0; j < inst.numColumns; j++)
+  {
+    SCPlists::Range R = inst.ColEntries[j];
+    if (R.size() == 0) continue;
+
+    SCPcomponent &comp = comps[compOf[uf.find(R[0])]];
+    colIndex[j] = comp.cols.size();
+    comp.cols.push_back(j);
+    comp.nnz += R.size();
+  }
+
+  return comps;
+}
@@ -0,0 +1,27 @@
+//---------------------------------------------------------------------------
+// インスタンスの連結成分への分解
+// 行-列の2部グラフが分かれていれば，成分ごとに独立に解いて解を合わせればよい．
+// 列の行を union-find でまとめて成分を求め，成分ごとの部分インスタンスを作る．
+//---------------------------------------------------------------------------
+#pragma once
+
+#include "SCPv.hpp"
+#include <vector>
+
+//
+//  1つの連結成分（番号は元のインスタンスの内部の番号，昇順）
+//
+struct SCPcomponent
+{
+  std::vector<int> rows;        // 成分の行
+  std::vector<int> cols;        // 成分の列
+  long nnz;                     // 成分の非ゼロ要素の数（探索の大きさの目安）
+
+  SCPcomponent() : nnz(0) {}
+};
+
+
+// inst を連結成分に分ける．成分は最小の行番号の順
+// colIndex[j] には列jの成分の中での番号を入れる（行のない列はどの成分にも入れず -1）
+std::vector<SCPcomponent> find_components(const SCPinstance &inst,
+                                          std::vector<int> &colIndex);
@@ -0,0 +1,108 @@
+#include "SCPgenerate.hpp"
+#include "Random.hpp"
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+
+// (0,1) の一様乱数（0.5 を足すので 0 と 1 にはならない）
+static double uniform01(Rand& rnd)
+{
+  return ((double)(rnd() & 0xffffffffu) + 0.5) / 4294967296.0;
+}
+
+
+// 行の次数を1つ決める
+static int row_degree(const GeneratorOptions& opt, double mean, Rand& rnd)
+{
+  int d;
+  if (opt.degree == DEGREE_POWERLAW)
+  {
+    // 平均が mean になる最小値 xm のパレート分布： mean = xm * alpha / (alpha - 1)
+    double a = max(opt.alpha, 1.05);
+    double xm = mean * (a - 1) / a;
+    // 乱数が 0 に近いと int に収まらないので，列の数で抑えてから変換する
+    d = (int)(min<double>(xm / pow(uniform01(rnd), 1.0 / a), opt.cols) + 0.5);
+  }
+  else
+  {
+    int lo = max(1, (int)(mean * 0.5 + 0.5));
+    int hi = max(lo, (int)(mean * 1.5 + 0.5));
+    d = rnd(lo, hi);
+  }
+  return min(opt.cols, max(d, max(opt.K, 1)));
+}
+
+
+// opt のインスタンスを file に書く
+bool generate_instance(const string &file, const GeneratorOptions &opt)
+{
+  if (opt.rows < 0 || opt.cols <= 0 || opt.K > opt.cols) return false;
+
+  Rand rnd;
+  rnd.seed(opt.seed);
+  double mean = max(1.0, opt.cols * opt.density);
+
+  // 行を先に作る（列のコストを次数から決めるため）
+  // 異なる列は並べ替えの先頭 d 個を部分的に Fisher-Yates で選ぶ
+  vector<int> perm(opt.cols);
+  for (int j = 0; j < opt.cols; j++) perm[j] = j;
+
+  vector<long> start(opt.rows + 1, 0);
+  vector<int> item;
+  vector<int> colDegree(opt.cols, 0);
+
+  for (int i = 0; i < opt.rows; i++)
+  {
+    int d = row_degree(opt, mean, rnd);
+    for (int k = 0; k < d; k++)
+    {
+      int j = rnd(k, opt.cols - 1);
+      swap(perm[k], perm[j]);
+      item.push_back(perm[k]);
+      colDegree[perm[k]]++;
+    }
+    sort(item.begin() + start[i], item.end());
+    start[i + 1] = item.size();
+  }
+
+  // コスト
+  vector<int> weight(opt.cols, 1);
+  int maxDegree = *max_element(colDegree.begin(), colDegree.end());
+  for (int j = 0; j < opt.cols; j++)
+  {
+    if (opt.cost == COST_UNIFORM)
+      weight[j] = rnd(1, max(1, opt.costMax));
+    else if (opt.cost == COST_DEGREE)
+    {
+      double w = (double)max(1, opt.costMax) * max(1, colDegree[j]) / max(1, maxDegree);
+      w *= 0.5 + uniform01(rnd);
+      weight[j] = min(max(1, opt.costMax), max(1, (int)(w + 0.5)));
+    }
+  }
+
+  // 書き出し（SCPinstance の形式：行数 列数，コスト，各行の次数と列番号（1から））
+  FILE* fp = fopen(file.c_str(), "w");
+  if (fp == NULL) return false;
+  vector<char> buf(1 << 20);
+  setvbuf(fp, buf.data(), _IOFBF, buf.size());
+
+  fprintf(fp, "%d %d\n", opt.rows, opt.cols);
+  for (int j = 0; j < opt.cols; j++)
+    fprintf(fp, (j % 12 == 11 || j + 1 == opt.cols) ? "%d\n" : "%d ", weight[j]);
+
+  for (int i = 0; i < opt.rows; i++)
+  {
+    long n = start[i + 1] - start[i];
+    fprintf(fp, "%ld\n", n);
+    for (long p = start[i]; p < start[i + 1]; p++)
+    {
+      long k = p - start[i];
+      fprintf(fp, (k % 12 == 11 || k + 1 == n) ? "%d\n" : "%d ", item[p] + 1);
+    }
+  }
+
+  return fclose(fp) == 0;
+}
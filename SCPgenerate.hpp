@@ -0,0 +1,43 @@
+//---------------------------------------------------------------------------
+// 合成インスタンスの生成
+// 行数・列数・密度・行の次数の分布・コストの分布を指定して，
+// SCPinstance で読めるファイルを書く．同じ seed なら同じファイルになる．
+// どの行も K 個以上の異なる列を含むので，K回カバーする解が必ずある．
+//---------------------------------------------------------------------------
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+enum DegreeDist
+{
+  DEGREE_UNIFORM,               // 行の次数は平均の半分から 1.5倍の一様分布
+  DEGREE_POWERLAW               // 行の次数はべき分布（パレート分布）
+};
+
+enum CostDist
+{
+  COST_UNICOST,                 // 全て 1
+  COST_UNIFORM,                 // 1..costMax の一様分布
+  COST_DEGREE                   // 列の次数に比例（1..costMax に収まるように，±50% の揺らぎ）
+};
+
+struct GeneratorOptions
+{
+  int rows;
+  int cols;
+  double density;               // 行列の非ゼロ要素の割合（行の次数の平均は cols * density）
+  DegreeDist degree;
+  double alpha;                 // べき分布の指数（>1，小さいほど裾が重い）
+  CostDist cost;
+  int costMax;
+  int K;                        // 全ての行の次数を K 以上にする
+  std::uint32_t seed;
+
+  GeneratorOptions()
+    : rows(1000), cols(10000), density(0.01), degree(DEGREE_UNIFORM), alpha(2.5),
+      cost(COST_UNIFORM), costMax(100), K(1), seed(1) {}
+};
+
+// opt のインスタンスを file に書く．書けなければ false
+bool generate_instance(const std::string &file, const GeneratorOptions &opt);
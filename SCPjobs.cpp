@@ -0,0 +1,104 @@
+#include "SCPjobs.hpp"
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <atomic>
+using namespace std;
+
+
+// コンストラクタ
+SCPjobPool::SCPjobPool(int n)
+  : steals(0), numThreads(max(1, n)), queues(max(1, n)), cost(NULL)
+{
+}
+
+
+// ジョブを大きい順に手間の合計が最も小さいキューへ入れ，ワーカーで実行する
+void SCPjobPool::run(const vector<double> &c, const function<void(int)> &job)
+{
+  cost = &c;
+  steals = 0;
+
+  vector<int> order(c.size());
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(), [&](int a, int b) { return c[a] > c[b]; });
+
+  for (Queue& q : queues)
+  {
+    q.jobs.clear();
+    q.remaining = 0;
+  }
+  vector<double> load(numThreads, 0);
+  for (int j : order)
+  {
+    int t = min_element(load.begin(), load.end()) - load.begin();
+    load[t] += c[j];
+    queues[t].jobs.push_back(j);
+    queues[t].remaining += c[j];
+  }
+
+  atomic<long> stolen(0);
+  auto worker = [&](int t) {
+    bool st;
+    for (int j = next_job(t, st); j >= 0; j = next_job(t, st))
+    {
+      if (st) stolen++;
+      job(j);
+    }
+  };
+
+  int n = min(numThreads, max(1, (int)c.size()));
+  vector<std::thread> threads;
+  for (int t = 1; t < n; t++) threads.push_back(std::thread(worker, t));
+  worker(0);
+  for (std::thread& th : threads) th.join();
+
+  steals = stolen;
+  cost = NULL;
+}
+
+
+// 自分のキューの先頭を取る．空なら残りの手間が最も大きいキューの先頭を盗む
+int SCPjobPool::next_job(int t, bool &stolen)
+{
+  stolen = false;
+  {
+    Queue& q = queues[t];
+    lock_guard<mutex> lock(q.m);
+    if (!q.jobs.empty())
+    {
+      int j = q.jobs.front();
+      q.jobs.pop_front();
+      q.remaining -= (*cost)[j];
+      return j;
+    }
+  }
+
+  while (true)
+  {
+    // 残りの手間が最も大きいキューを選ぶ（読むときだけ鍵をかける）
+    int victim = -1;
+    double most = 0;
+    for (int v = 0; v < numThreads; v++)
+    {
+      if (v == t) continue;
+      lock_guard<mutex> lock(queues[v].m);
+      if (!queues[v].jobs.empty() && (victim < 0 || queues[v].remaining > most))
+      {
+        victim = v;
+        most = queues[v].remaining;
+      }
+    }
+    if (victim < 0) return -1;
+
+    // 選んでから盗むまでに空になっていたら選び直す
+    Queue& q = queues[victim];
+    lock_guard<mutex> lock(q.m);
+    if (q.jobs.empty()) continue;
+    int j = q.jobs.front();
+    q.jobs.pop_front();
+    q.remaining -= (*cost)[j];
+    stolen = true;
+    return j;
+  }
+}
@@ -0,0 +1,42 @@
+//---------------------------------------------------------------------------
+// バッチのジョブをスレッドで分けて実行する
+// ジョブの手間（見積もり）が分かっているとき，大きいものから順に，その時点で
+// 割り当てた手間の合計が最も小さいスレッドのキューに入れる．各スレッドは
+// 自分のキューの先頭（大きいもの）から取り，空になったら残りの手間が
+// 最も大きいスレッドのキューから先頭のジョブを盗む．
+//---------------------------------------------------------------------------
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <functional>
+
+class SCPjobPool
+{
+public:
+  explicit SCPjobPool(int numThreads);
+
+  // ジョブ j = 0..cost.size()-1 を job(j) で実行し，全て終わるまで待つ
+  // 呼び出し側のスレッドも1つのワーカーとして働く
+  void run(const std::vector<double> &cost, const std::function<void(int)> &job);
+
+  int size() const { return numThreads; }
+
+  long steals;                          // 直前の run で盗んだジョブの数
+
+private:
+  struct Queue
+  {
+    std::mutex m;
+    std::deque<int> jobs;
+    double remaining;                   // キューに残っているジョブの手間の合計
+  };
+
+  int numThreads;
+  std::vector<Queue> queues;
+  const std::vector<double>* cost;
+
+  // ワーカー t が次に実行するジョブ（なければ -1）．他のキューから取ったら stolen = true
+  int next_job(int t, bool &stolen);
+};
@@ -0,0 +1,675 @@
+//---------------------------------------------------------------------------
+// DLL_com の部品（スコアの更新，列の選択，貪欲法）
+// skcp.cpp の探索とベンチマーク（skcp_bench.cpp）から使う．
+// COVERED の型ごとに実体化されるのでヘッダに置く
+//---------------------------------------------------------------------------
+#pragma once
+
+#include "SCPv.hpp"
+#include "Random.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+
+//
+//  探索の作業用の配列
+//  列の選択や貪欲法で使う一時的な配列をここにまとめ，探索の前に大きさを確保しておく．
+//  反復の中では clear と push_back しかしないので，ヒープの確保は起こらない
+//
+struct SCPworkspace
+{
+  std::vector<int> maxCols;     // 最大スコアの列（同点の列）
+  std::vector<int> rcl;         // GRASP の候補リスト
+  std::vector<int> score;       // 貪欲法のスコア（列数の大きさ）
+  std::vector<std::vector<int> > uncovered;     // 重みの更新でスレッドごとに集める行
+
+  SCPworkspace() {}
+  explicit SCPworkspace(const SCPinstance& inst) { reserve(inst); }
+
+  // インスタンスの列数に合わせて確保する
+  void reserve(const SCPinstance& inst)
+  {
+    maxCols.reserve(inst.numColumns);
+    rcl.reserve(inst.numColumns);
+    score.resize(inst.numColumns, 0);
+  }
+
+  // 重みの更新を threads 個のスレッドで分けるときの分を確保する
+  void reserve_rows(const SCPinstance& inst, int threads)
+  {
+    if ((int)uncovered.size() < threads) uncovered.resize(threads);
+    for (std::vector<int>& u : uncovered) u.reserve(inst.numRows);
+  }
+};
+
+
+//
+//  探索を K とコストの種類で特殊化するための型（SCPkernel の部品と DLL_com の Spec）
+//  KC > 0 なら K はコンパイル時の定数 KC（cs.K と同じであること），0 なら cs.K を使う
+//  UNIT なら全ての列のコストが 1 なので，スコア/コスト の割り算を省く
+//
+template <int KC, bool UNIT>
+struct SCPspec
+{
+  template <typename CovT>
+  static int k(const SCPsolution<CovT>& cs) { return KC > 0 ? KC : cs.K; }
+
+  static double ratio(int score, int weight)
+  {
+    return UNIT ? (double)score : (double)score / (double)weight;
+  }
+};
+
+typedef SCPspec<0, false> SCPgeneric;
+
+
+template <typename CovT, typename Spec = SCPgeneric>
+int compute_score(SCPinstance& inst,
+                  SCPsolution<CovT>& cs,
+                  int c)
+{
+  const int K = Spec::k(cs);
+  int sc = 0;
+  for (int r : inst.ColEntries[c]) {
+    if (cs.SOLUTION(c) && (cs.COVERED[r] == K)) sc -= cs.COST[r];
+    else if (!cs.SOLUTION(c) && cs.COVERED[r] < K) sc += cs.COST[r];
+  }
+  return sc;
+}
+
+
+// csに含まれない列から最大スコアのものを選んで返す
+template <typename CovT>
+int get_column_maxscore(SCPinstance &inst,
+                        SCPsolution<CovT>& cs,
+                        SCPworkspace& ws,
+                        Rand& rnd)
+{
+  std::vector<int>& score = ws.score;
+  std::vector<int>& maxCols = ws.maxCols;
+  maxCols.clear();
+  double maxScore = 0.0;
+  int maxc = 0;
+  double scw = 0.0;
+
+  for (int c = 0; c < inst.numColumns; c++)
+  {
+    if (cs.SOLUTION(c)) { continue; }
+
+    scw = (double)score[c]/(double)inst.Weight[c];
+    // 最大スコアの列をチェック
+    if (maxScore < scw)
+    {
+      maxScore = scw;
+      maxCols.clear();
+      maxCols.push_back(c);
+    }
+    else if (maxScore == scw)
+      maxCols.push_back(c);
+  } // End for c
+
+  if (maxCols.size() == 1) maxc = maxCols[0];
+  else
+  {
+    int j = rnd(0, maxCols.size() - 1);
+    maxc = maxCols[j];
+  }
+
+  return maxc;
+}
+
+
+// GRASP の制限付き候補リスト：csに含まれない列のうち
+// score/重み が alpha * 最大値 以上のものから無作為に1つ選んで返す
+template <typename CovT>
+int get_column_grasp(SCPinstance &inst,
+                     SCPsolution<CovT>& cs,
+                     double alpha,
+                     SCPworkspace& ws,
+                     Rand& rnd)
+{
+  std::vector<int>& score = ws.score;
+  std::vector<int>& rcl = ws.rcl;
+  double maxScore = 0.0;
+  for (int c : cs.Cand)
+    maxScore = std::max(maxScore, (double)score[c]/(double)inst.Weight[c]);
+
+  double th = alpha * maxScore;
+  rcl.clear();
+  for (int c : cs.Cand)
+  {
+    double scw = (double)score[c]/(double)inst.Weight[c];
+    if (scw > 0.0 && scw >= th) rcl.push_back(c);
+  }
+
+  if (rcl.empty()) return get_column_maxscore(inst, cs, ws, rnd);
+  return rcl[rnd(0, rcl.size() - 1)];
+}
+
+
+template <typename CovT, typename Spec = SCPgeneric>
+int get_add_rule(SCPinstance &inst,
+		 SCPsolution<CovT>& cs,
+		 const std::vector<int>* core,
+		 SCPworkspace& ws,
+		 Rand& rnd)
+{
+  std::vector<int>& maxCols = ws.maxCols;
+  maxCols.clear();
+  double maxScore = 0.0;
+  int retc = 0;
+  double scw = 0.0;
+  int oldest_time = std::numeric_limits<int>::max();
+
+  auto check = [&](int c)
+  {
+    if (cs.SOLUTION(c)) { return; }
+    if (!cs.SKCC(c)) { return; }
+
+
+    scw = Spec::ratio(cs.SCORE(c), cs.Weight(c));
+    // 最大スコアの列をチェック
+    if (maxScore < scw)
+    {
+      maxScore = scw;
+      maxCols.clear();
+      maxCols.push_back(c);
+    }
+    else if (maxScore == scw)
+      maxCols.push_back(c);
+  };
+
+  // core があればその列だけを見る．スコアが正の列がなければ全ての列を見る
+  if (core != NULL)
+  {
+    for (int c : *core) check(c);
+  }
+  if (core == NULL || maxScore <= 0.0)
+  {
+    maxCols.clear();
+    for (int c = 0; c < inst.numColumns; c++) check(c);
+  } // End for c
+
+  if (maxCols.size() == 1) retc = maxCols[0];
+  else
+  {
+    for (int c : maxCols) {
+      if (cs.TIMES(c) < oldest_time) {
+        oldest_time = cs.TIMES(c);
+        retc = c;
+      }
+    }
+  }
+
+  return retc;
+} // add_rule
+
+
+// BMS の ADD-RULE：CS に含まれない列から t 個を無作為に選び（重複を許す），
+// その中で get_add_rule と同じ基準の最良の列を返す
+// スコアが正の列が見つからなければ全ての列を見る
+template <typename CovT, typename Spec = SCPgeneric>
+int get_add_rule_bms(SCPinstance &inst,
+                     SCPsolution<CovT>& cs,
+                     int t,
+                     SCPworkspace& ws,
+                     Rand& rnd)
+{
+  double maxScore = 0.0;
+  int retc = -1;
+
+  int n = cs.Cand.size();
+  for (int i = 0; i < t && n > 0; i++)
+  {
+    int c = cs.Cand[rnd(0, n - 1)];
+    if (!cs.SKCC(c)) continue;
+
+    double scw = Spec::ratio(cs.SCORE(c), cs.Weight(c));
+    if (maxScore < scw || (maxScore == scw && retc >= 0 && cs.TIMES(c) < cs.TIMES(retc)))
+    {
+      maxScore = scw;
+      retc = c;
+    }
+  }
+
+  if (retc < 0) return get_add_rule<CovT, Spec>(inst, cs, (const std::vector<int>*)NULL, ws, rnd);
+  return retc;
+}
+
+
+// REMOVE-RULE
+template <typename CovT, typename Spec = SCPgeneric>
+int get_remove_rule(SCPinstance &inst,
+		    SCPsolution<CovT>& cs,
+                    int iter,
+		    SCPworkspace& ws,
+		    Rand& rnd)
+{
+  const int K = Spec::k(cs);
+  std::vector<int>& maxCols = ws.maxCols;
+  maxCols.clear();
+  double maxScore = std::numeric_limits<int>::min();
+  int retc = 0;
+  double scw = 0.0;
+
+  int oldest_time = std::numeric_limits<int>::max();
+  bool oldest = (rnd(100) >= 95);
+
+  if (!oldest)
+  {
+    for (int c : cs.CS) {
+      if (cs.TIMES(c) > 0 && cs.TIMES(c) == iter - 1) continue;
+
+      // Araki
+      // スコアが0の列の取り扱い
+      // すべての行をk回カバーしている場合のみ取り除く
+      bool flg = false;
+      if (cs.SCORE(c) == 0) {
+        for (int r : inst.ColEntries[c]) {
+          if (cs.COVERED[r] < K) {
+            flg = true;
+            break;
+          }
+        }
+        if (flg) continue;
+      }
+
+      scw = Spec::ratio(cs.SCORE(c), cs.Weight(c));
+
+      // 最大スコアの列をチェック
+      if (maxScore < scw)  {
+        maxScore = scw;
+        maxCols.clear();
+        maxCols.push_back(c);
+      }
+      else if (maxScore == scw)
+        maxCols.push_back(c);
+    } // End for c
+
+    if (maxCols.size() == 1) retc = maxCols[0];
+    else
+    {
+      for (int c : maxCols) {
+        if (cs.TIMES(c) < oldest_time) {
+          oldest_time = cs.TIMES(c);
+          retc = c;
+        }
+      }
+    }
+
+    // 全ての列が除かれたら（コストが全て等しいときに起こる）5% の方と同じにする
+    oldest = maxCols.empty();
+  }
+
+  if (oldest)
+  {
+    // 5%
+    int maxw = 0;
+    for (int c : cs.CS) {
+      if (cs.TIMES(c) < oldest_time) {
+        oldest_time = cs.TIMES(c);
+        maxw = cs.Weight(c);
+        retc = c;
+      }
+      else if (cs.TIMES(c) == oldest_time) {
+        if (maxw < cs.Weight(c)) {
+          maxw = cs.Weight(c);
+          retc = c;
+        }
+      }
+    }
+  }
+  return retc;
+}
+
+
+// BMS の REMOVE-RULE：CS から t 個を無作為に選び（重複を許す），
+// その中で get_remove_rule と同じ基準の列を返す
+// 条件に合う列が見つからなければ全ての列を見る
+template <typename CovT, typename Spec = SCPgeneric>
+int get_remove_rule_bms(SCPinstance &inst,
+                        SCPsolution<CovT>& cs,
+                        int iter,
+                        int t,
+                        SCPworkspace& ws,
+                        Rand& rnd)
+{
+  const int K = Spec::k(cs);
+  int n = cs.CS.size();
+  int retc = -1;
+
+  if (rnd(100) < 95)
+  {
+    double maxScore = std::numeric_limits<int>::min();
+
+    for (int i = 0; i < t && n > 0; i++)
+    {
+      int c = cs.CS[rnd(0, n - 1)];
+      if (cs.TIMES(c) > 0 && cs.TIMES(c) == iter - 1) continue;
+
+      // スコアが0の列は，すべての行をk回カバーしている場合のみ取り除く
+      if (cs.SCORE(c) == 0)
+      {
+        bool flg = false;
+        for (int r : inst.ColEntries[c]) {
+          if (cs.COVERED[r] < K) { flg = true; break; }
+        }
+        if (flg) continue;
+      }
+
+      double scw = Spec::ratio(cs.SCORE(c), cs.Weight(c));
+      if (maxScore < scw || (maxScore == scw && retc >= 0 && cs.TIMES(c) < cs.TIMES(retc)))
+      {
+        maxScore = scw;
+        retc = c;
+      }
+    }
+  }
+  else
+  {
+    // 5%：選んだ中で最も古い列（同じなら重い列）
+    for (int i = 0; i < t && n > 0; i++)
+    {
+      int c = cs.CS[rnd(0, n - 1)];
+      if (retc < 0 || cs.TIMES(c) < cs.TIMES(retc)
+          || (cs.TIMES(c) == cs.TIMES(retc) && cs.Weight(c) > cs.Weight(retc)))
+        retc = c;
+    }
+  }
+
+  if (retc < 0) return get_remove_rule<CovT, Spec>(inst, cs, iter, ws, rnd);
+  return retc;
+}
+
+
+// 配列の順序をランダムに入れ替える
+inline void random_permutation(std::vector<int>& A, Rand& rnd)
+{
+  int j;
+  int n = A.size();
+  for (int i = 0; i < n-1; ++i)
+  {
+    j = rnd(i, n-1);
+    std::swap(A[i], A[j]);
+  }
+}
+
+
+template <typename CovT, typename Spec = SCPgeneric>
+void add_update_score(SCPinstance& inst, SCPsolution<CovT>& cs, int c)
+{
+  const int K = Spec::k(cs);
+  cs.SCORE(c) = 0;
+  for (int r : inst.ColEntries[c])
+  {
+    if (cs.COVERED[r] == K) cs.SCORE(c) -= cs.COST[r];
+  }
+
+  for (int r : inst.ColEntries[c])
+  {
+    if (cs.COVERED[r] == K)
+    {
+      for (int rc : inst.RowCovers[r]) {
+        if (rc != c) cs.SCORE(rc) -= cs.COST[r];
+      }
+    }
+    else if (cs.COVERED[r] == K + 1)
+    {
+      for (int rc : inst.RowCovers[r])
+      {
+	if (cs.SOLUTION(rc) && rc != c) {
+	  cs.SCORE(rc) += cs.COST[r];
+	}
+      }
+    } // End if covered[r] == K+1
+  } // end for r
+}
+
+
+template <typename CovT, typename Spec = SCPgeneric>
+void remove_update_score(SCPinstance& inst, SCPsolution<CovT>& cs, int c)
+{
+  const int K = Spec::k(cs);
+  cs.SCORE(c) = 0;
+  for (int r : inst.ColEntries[c])
+  {
+    if (cs.COVERED[r] < K) cs.SCORE(c) += cs.COST[r];
+  }
+
+  for (int r : inst.ColEntries[c])
+  {
+    // r行がK回カバーされなくなったら，rを含む行のスコアを増加
+    if (cs.COVERED[r] == K-1) {
+	for (int rc : inst.RowCovers[r])
+        {
+	  if (rc != c)
+          {
+            cs.SCORE(rc) += cs.COST[r];
+          }
+	} // End: for rc
+      }
+    else if (cs.COVERED[r] == K)
+    {
+      for (int rc : inst.RowCovers[r])
+      {
+        if (cs.SOLUTION(rc) && rc != c)
+        {
+          cs.SCORE(rc) -= cs.COST[r];
+        }
+      }
+    }
+  } // end for r
+} // end remove_update_score
+
+
+// 列cの追加・削除による他の列のスコアの更新のうち，列番号が [lo, hi) の列の分だけを行う
+// （RowCovers の各行は昇順なので，範囲の始めを二分探索で見つける）
+// 範囲が重ならなければ別々のスレッドで同時に呼んでよい．SCORE(c) は変えない
+template <typename CovT, typename Spec = SCPgeneric>
+void add_update_score_range(SCPinstance& inst, SCPsolution<CovT>& cs, int c, int lo, int hi)
+{
+  const int K = Spec::k(cs);
+  for (int r : inst.ColEntries[c])
+  {
+    bool atK = (cs.COVERED[r] == K);
+    if (!atK && cs.COVERED[r] != K + 1) continue;
+
+    SCPlists::Range R = inst.RowCovers[r];
+    const int* p = std::lower_bound(R.begin(), R.end(), lo);
+    for (; p != R.end() && *p < hi; ++p)
+    {
+      int rc = *p;
+      if (rc == c) continue;
+      if (atK) cs.SCORE(rc) -= cs.COST[r];
+      else if (cs.SOLUTION(rc)) cs.SCORE(rc) += cs.COST[r];
+    }
+  }
+}
+
+template <typename CovT, typename Spec = SCPgeneric>
+void remove_update_score_range(SCPinstance& inst, SCPsolution<CovT>& cs, int c, int lo, int hi)
+{
+  const int K = Spec::k(cs);
+  for (int r : inst.ColEntries[c])
+  {
+    bool below = (cs.COVERED[r] == K - 1);
+    if (!below && cs.COVERED[r] != K) continue;
+
+    SCPlists::Range R = inst.RowCovers[r];
+    const int* p = std::lower_bound(R.begin(), R.end(), lo);
+    for (; p != R.end() && *p < hi; ++p)
+    {
+      int rc = *p;
+      if (rc == c) continue;
+      if (below) cs.SCORE(rc) += cs.COST[r];
+      else if (cs.SOLUTION(rc)) cs.SCORE(rc) -= cs.COST[r];
+    }
+  }
+}
+
+
+// 列cの追加：add_column と add_update_score を行ごとに1回の走査で行う
+// 各行の更新はその行の COVERED だけで決まるので，行ごとに続けて行っても結果は同じ
+// resetCost >= 0 なら，K回カバーになった行で COST が resetCost を超えるものの COST を1に戻し，
+// その行の分のスコアも合わせる（解の列は -1，解にない列は 0 になる）
+template <typename CovT, typename Spec = SCPgeneric>
+void add_column_update(SCPinstance& inst, SCPsolution<CovT>& cs, int c, int resetCost = -1)
+{
+  const int K = Spec::k(cs);
+  cs.enter_column(c);
+
+  int sc = 0;
+  for (int r : inst.ColEntries[c])
+  {
+    int v = ++cs.COVERED[r];
+    if (v == K)
+    {
+      cs.num_Cover++;
+      int w = cs.COST[r];
+      if (resetCost >= 0 && w > resetCost)
+      {
+        cs.COST[r] = 1;
+        sc -= 1;
+        for (int rc : inst.RowCovers[r]) {
+          if (rc != c) cs.SCORE(rc) -= cs.SOLUTION(rc) ? 1 : w;
+        }
+      }
+      else
+      {
+        sc -= w;
+        for (int rc : inst.RowCovers[r]) {
+          if (rc != c) cs.SCORE(rc) -= w;
+        }
+      }
+    }
+    else if (v == K + 1)
+    {
+      int w = cs.COST[r];
+      for (int rc : inst.RowCovers[r]) {
+        if (cs.SOLUTION(rc) && rc != c) cs.SCORE(rc) += w;
+      }
+    }
+  }
+  cs.SCORE(c) = sc;
+} // end add_column_update
+
+
+// 列cの削除：remove_column と remove_update_score を行ごとに1回の走査で行う
+template <typename CovT, typename Spec = SCPgeneric>
+void remove_column_update(SCPinstance& inst, SCPsolution<CovT>& cs, int c)
+{
+  const int K = Spec::k(cs);
+  cs.leave_column(c);
+
+  int sc = 0;
+  for (int r : inst.ColEntries[c])
+  {
+    int v = --cs.COVERED[r];
+    if (v >= K + 1) continue;
+
+    int w = cs.COST[r];
+    if (v == K)
+    {
+      for (int rc : inst.RowCovers[r]) {
+        if (cs.SOLUTION(rc)) cs.SCORE(rc) -= w;
+      }
+      continue;
+    }
+
+    sc += w;
+    if (v == K - 1)
+    {
+      cs.num_Cover--;
+      for (int rc : inst.RowCovers[r]) {
+        if (rc != c) cs.SCORE(rc) += w;
+      }
+    }
+  }
+  cs.SCORE(c) = sc;
+} // end remove_column_update
+
+
+// 列colの近傍のSKCCを1にする
+template <typename CovT>
+void update_SKCC(SCPinstance& inst, SCPsolution<CovT>& cs, int col)
+{
+  for (int c : inst.Neighborhood[col]) {
+      cs.SKCC(c) = 1;
+  }
+  // for (int r : inst.ColEntries[col]) {
+  //   if (cs.COVERED[r] < cs.K) {
+  //     for (int rc : inst.RowCovers[r]) {
+  //       if (rc != col) cs.SKCC(rc) = 1;
+  //     }
+  //   }
+  // }
+}
+
+
+
+// 貪欲法：スコア最大の列を実行可能になるまで選ぶ
+// alpha < 1 なら スコアが alpha * 最大値 以上の列から無作為に選ぶ（GRASP）
+// cs に入っている列から始め，結果は cs に入る
+// ws.score を作業用に使う
+template <typename CovT>
+void greedy_construction(SCPinstance &inst,
+                         SCPsolution<CovT> &cs,
+                         SCPworkspace &ws,
+                         Rand &rnd,
+                         double alpha = 1.0)
+{
+  std::vector<int> &score = ws.score;
+
+  // score[c]: 列cがカバーする行のうち K回カバーされていない行の数
+  for (int c = 0; c < inst.numColumns; c++)
+  {
+    score[c] = 0;
+    if (cs.SOLUTION(c)) continue;
+    for (int r : inst.ColEntries[c])
+      if (cs.COVERED[r] < cs.K) score[c]++;
+  }
+
+  int ca;
+
+  while (cs.num_Cover < inst.numRows)
+  {
+    if (alpha < 1.0) ca = get_column_grasp(inst, cs, alpha, ws, rnd);
+    else ca = get_column_maxscore(inst, cs, ws, rnd);
+    cs.add_column(inst, ca);
+
+    // スコア更新
+    score[ca] = 0;
+    for (int r : inst.ColEntries[ca])
+    {
+      if (cs.COVERED[r] == cs.K)
+      {
+        for (int rc : inst.RowCovers[r])
+          if (!cs.SOLUTION(rc) && rc != ca) score[rc]--;
+      }
+    } // end for r
+  } // End while num_Cover
+}
+
+
+
+
+// 冗長な列（取り除いても全ての行がK回以上カバーされる列）を重い順に取り除く
+// cs は実行可能解であること
+template <typename CovT>
+void prune_redundant(SCPinstance &inst, SCPsolution<CovT> &cs)
+{
+  std::vector<int> cols(cs.CS);
+  std::sort(cols.begin(), cols.end(),
+       [&](int a, int b) { return cs.Weight(a) > cs.Weight(b); });
+
+  for (int c : cols)
+  {
+    bool redundant = true;
+    for (int r : inst.ColEntries[c])
+    {
+      if (cs.COVERED[r] <= cs.K) { redundant = false; break; }
+    }
+    if (redundant) cs.remove_column(inst, c);
+  }
+}
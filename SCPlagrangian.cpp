@@ -0,0 +1,166 @@
+#include "SCPlagrangian.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+//
+//
+// Class SCPlagrangian
+//
+//
+
+// コンストラクタ
+// 乗数の初期値は u_i = min_{j in R_i} w_j / |C_j|
+SCPlagrangian::SCPlagrangian(SCPinstance &pData, int k)
+  : K(k), LB(0.0), iterations(0), inst(pData), lambda(2.0)
+{
+  cu.assign(inst.numRows, 0.0);
+  crc.assign(inst.numColumns, 0.0);
+  g.assign(inst.numRows, 0);
+
+  for (int i = 0; i < inst.numRows; i++)
+  {
+    double m = -1.0;
+    for (int c : inst.RowCovers[i])
+    {
+      double v = (double)inst.Weight[c] / inst.ColEntries[c].size();
+      if (m < 0 || v < m) m = v;
+    }
+    cu[i] = (m < 0) ? 0.0 : m;
+  }
+
+  LB = evaluate();
+  u = cu;
+  RC = crc;
+}
+
+
+// 乗数 cu での L(u) を計算する
+double SCPlagrangian::evaluate()
+{
+  double L = 0.0;
+
+  for (int i = 0; i < inst.numRows; i++) L += K * cu[i];
+
+  for (int j = 0; j < inst.numColumns; j++)
+  {
+    if (inst.ColEntries[j].size() == 0) { crc[j] = 0.0; continue; }   // 削除された列
+
+    double rc = inst.Weight[j];
+    for (int r : inst.ColEntries[j]) rc -= cu[r];
+    crc[j] = rc;
+    if (rc < 0) L += rc;
+  }
+
+  return L;
+}
+
+
+// 劣勾配法
+// 下界が 30 回改善しなければステップの係数を半分にする
+double SCPlagrangian::compute(int UB, int max_iter)
+{
+  int noImprove = 0;
+
+  for (int it = 0; it < max_iter; it++)
+  {
+    if (integer_bound() >= UB || lambda < 0.005) break;
+
+    // 劣勾配 g_i = K - (被約費用が負の列で行iをカバーするものの数)
+    long norm = 0;
+    for (int i = 0; i < inst.numRows; i++)
+    {
+      int n = 0;
+      for (int c : inst.RowCovers[i])
+        if (crc[c] < 0) n++;
+      g[i] = K - n;
+      if (cu[i] <= 0.0 && g[i] < 0) g[i] = 0;
+      norm += (long)g[i] * g[i];
+    }
+    if (norm == 0) break;       // u が最適
+
+    double step = lambda * (UB - LB) / norm;
+    for (int i = 0; i < inst.numRows; i++)
+      cu[i] = std::max(0.0, cu[i] + step * g[i]);
+
+    double L = evaluate();
+    iterations++;
+
+    if (L > LB + 1e-9)
+    {
+      LB = L;
+      u = cu;
+      RC = crc;
+      noImprove = 0;
+    }
+    else if (++noImprove >= 30)
+    {
+      lambda /= 2;
+      noImprove = 0;
+    }
+  }
+
+  return LB;
+}
+
+
+// 整数に切り上げた下界（丸め誤差の分だけ余裕をとる）
+int SCPlagrangian::integer_bound() const
+{
+  return (int)std::ceil(LB - 1e-6);
+}
+
+
+
+//
+//
+// Class SCPcore
+//
+//
+
+// コンストラクタ
+SCPcore::SCPcore(SCPinstance &pData, SCPlagrangian &lag_, int perRow_)
+  : inst(pData), lag(lag_), perRow(perRow_)
+{
+  In.assign(inst.numColumns, 0);
+  expand();
+}
+
+
+// lag.RC でコアに列を追加する
+void SCPcore::expand()
+{
+  const std::vector<double>& RC = lag.RC;
+  std::size_t m = lag.K + perRow;
+
+  for (int j = 0; j < inst.numColumns; j++)
+  {
+    if (!In[j] && RC[j] < 0 && inst.ColEntries[j].size() > 0)
+    {
+      In[j] = 1;
+      Columns.push_back(j);
+    }
+  }
+
+  for (int i = 0; i < inst.numRows; i++)
+  {
+    cand.assign(inst.RowCovers[i].begin(), inst.RowCovers[i].end());
+    if (cand.size() > m)
+    {
+      std::nth_element(cand.begin(), cand.begin() + m, cand.end(),
+                       [&](int a, int b) { return RC[a] < RC[b]; });
+      cand.resize(m);
+    }
+    for (int c : cand)
+    {
+      if (!In[c])
+      {
+        In[c] = 1;
+        Columns.push_back(c);
+      }
+    }
+  }
+
+  // 列番号の順に走査できるように並べておく
+  std::sort(Columns.begin(), Columns.end());
+}
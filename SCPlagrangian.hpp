@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------------
+// 集合Kカバー問題のラグランジュ緩和による下界
+//
+//   min sum_j w_j x_j  s.t.  sum_{j in R_i} x_j >= K,  x_j in {0,1}
+//
+// の被覆制約を乗数 u_i >= 0 で緩和すると，被約費用 RC_j = w_j - sum_{i in C_j} u_i
+// に対して L(u) = K * sum_i u_i + sum_j min(0, RC_j) が下界になる．
+// u は劣勾配法で更新する．
+//---------------------------------------------------------------------------
+#pragma once
+
+#include "SCPv.hpp"
+#include <vector>
+#include <cstdint>
+
+class SCPlagrangian
+{
+public:
+  int K;
+  double LB;                    // これまでで最良の下界
+  std::vector<double> u;        // u[i]: 行iの乗数（最良の下界のとき）
+  std::vector<double> RC;       // RC[j]: 列jの被約費用（最良の下界のとき）
+  int iterations;               // 劣勾配法の反復回数
+
+public:
+  SCPlagrangian(SCPinstance &pData, int k);
+
+  // 上界 UB（実行可能解の重み）を使って劣勾配法を max_iter 回まで行い，下界を返す
+  // 前回の乗数から続けるので，何度呼んでもよい
+  double compute(int UB, int max_iter);
+
+  // 重みは整数なので，整数に切り上げた下界
+  int integer_bound() const;
+
+private:
+  SCPinstance &inst;
+  std::vector<double> cu;       // 現在の乗数
+  std::vector<double> crc;      // 現在の被約費用
+  std::vector<int> g;           // 劣勾配
+  double lambda;                // ステップの係数
+
+  // 乗数 cu での L(u) を計算し，crc を更新する
+  double evaluate();
+};
+
+
+//
+//  Class SCPcore  被約費用の小さい列に絞った候補の集合（コア）
+//
+//  各行について，その行をカバーする列のうち被約費用の小さいものから
+//  K + perRow 列と，被約費用が負の列をコアに入れる．
+//  expand はそのときの被約費用で列を追加する（コアは大きくなるだけ）
+//
+class SCPcore
+{
+public:
+  std::vector<int> Columns;             // コアの列
+  std::vector<std::uint8_t> In;         // In[j] = 1: 列jがコアに含まれる
+
+public:
+  SCPcore(SCPinstance &pData, SCPlagrangian &lag, int perRow);
+
+  // lag.RC でコアに列を追加する
+  void expand();
+
+private:
+  SCPinstance &inst;
+  SCPlagrangian &lag;
+  int perRow;
+  std::vector<int> cand;                // expand の作業用
+};
@@ -0,0 +1,211 @@
+#include "SCPlns.hpp"
+#include <limits>
+using namespace std;
+
+
+//
+// Class SCPrepair
+//
+
+// コンストラクタ．作業用の配列はここで確保する
+SCPrepair::SCPrepair(int maxR, int maxC, int limit)
+  : maxRows(maxR), maxCols(maxC), nodeLimit(limit), nRow(0), nCol(0), best(0), nodes(0)
+{
+  w.reserve(maxCols);
+  need.reserve(maxRows);
+  colStart.reserve(maxCols + 1);
+  colItem.reserve((size_t)maxRows * maxCols);
+  rowStart.reserve(maxRows + 1);
+  rowItem.reserve((size_t)maxRows * maxCols);
+  rowFill.reserve(maxRows);
+  x.reserve(maxCols);
+  bestX.reserve(maxCols);
+}
+
+
+void SCPrepair::clear()
+{
+  nRow = nCol = 0;
+  w.clear();
+  need.clear();
+  colStart.assign(1, 0);
+  colItem.clear();
+}
+
+
+void SCPrepair::add_row(int demand)
+{
+  need.push_back(demand);
+  nRow++;
+}
+
+
+void SCPrepair::add_column(int weight)
+{
+  w.push_back(weight);
+  colStart.push_back(colItem.size());
+  nCol++;
+}
+
+
+void SCPrepair::add_entry(int row)
+{
+  colItem.push_back(row);
+  colStart.back()++;
+}
+
+
+// 行ごとの列のリストを作り，各行の列を重みの昇順にする
+void SCPrepair::finish()
+{
+  rowStart.assign(nRow + 1, 0);
+  for (int r : colItem) rowStart[r + 1]++;
+  for (int i = 0; i < nRow; i++) rowStart[i + 1] += rowStart[i];
+
+  rowItem.assign(colItem.size(), 0);
+  rowFill.assign(rowStart.begin(), rowStart.end() - 1);
+  for (int j = 0; j < nCol; j++)
+    for (int p = colStart[j]; p < colStart[j + 1]; p++) rowItem[rowFill[colItem[p]]++] = j;
+
+  // 行は短いので挿入ソート（stable_sort のように作業用の領域を確保しない）
+  for (int i = 0; i < nRow; i++)
+  {
+    for (int p = rowStart[i] + 1; p < rowStart[i + 1]; p++)
+    {
+      int j = rowItem[p], q = p;
+      for (; q > rowStart[i] && w[rowItem[q - 1]] > w[j]; q--) rowItem[q] = rowItem[q - 1];
+      rowItem[q] = j;
+    }
+  }
+}
+
+
+// 分枝限定法
+bool SCPrepair::solve(int upper, vector<int> &chosen)
+{
+  x.assign(nCol, -1);
+  best = upper;
+  nodes = 0;
+
+  // 見つかったかどうかは bestX が空かどうかで分かる
+  bestX.clear();
+  dfs(0);
+
+  chosen.clear();
+  if (bestX.empty()) return false;
+  for (int j = 0; j < nCol; j++)
+    if (bestX[j] == 1) chosen.push_back(j);
+  return true;
+}
+
+
+void SCPrepair::dfs(int cost)
+{
+  if (++nodes > nodeLimit) return;
+
+  // 下界と分枝する行：残りの需要を安い未定の列で満たす重みの最大値，
+  // 分枝は 未定の列の数 - 需要 が最小の行で行う
+  int bound = 0;
+  int branchRow = -1, minSlack = numeric_limits<int>::max();
+  for (int i = 0; i < nRow; i++)
+  {
+    if (need[i] <= 0) continue;
+
+    int cnt = 0, sum = 0;
+    for (int p = rowStart[i]; p < rowStart[i + 1]; p++)
+    {
+      int j = rowItem[p];
+      if (x[j] != -1) continue;
+      if (cnt < need[i]) sum += w[j];
+      cnt++;
+    }
+    if (cnt < need[i]) return;          // もう満たせない
+
+    bound = max(bound, sum);
+    if (cnt - need[i] < minSlack)
+    {
+      minSlack = cnt - need[i];
+      branchRow = i;
+    }
+  }
+
+  if (branchRow < 0)
+  {
+    // 全ての需要を満たした
+    if (cost < best)
+    {
+      best = cost;
+      bestX.assign(x.begin(), x.end());
+      for (int j = 0; j < nCol; j++) if (bestX[j] == -1) bestX[j] = 0;
+    }
+    return;
+  }
+  if (cost + bound >= best) return;
+
+  // 分枝する列：その行の未定の列のうち，重み / 需要のある行の数 が最小のもの
+  int col = -1;
+  double ratio = numeric_limits<double>::max();
+  for (int p = rowStart[branchRow]; p < rowStart[branchRow + 1]; p++)
+  {
+    int j = rowItem[p];
+    if (x[j] != -1) continue;
+
+    int n = 0;
+    for (int q = colStart[j]; q < colStart[j + 1]; q++) if (need[colItem[q]] > 0) n++;
+    double rt = (double)w[j] / n;
+    if (rt < ratio)
+    {
+      ratio = rt;
+      col = j;
+    }
+  }
+
+  // 入れる
+  x[col] = 1;
+  for (int q = colStart[col]; q < colStart[col + 1]; q++) need[colItem[q]]--;
+  dfs(cost + w[col]);
+  for (int q = colStart[col]; q < colStart[col + 1]; q++) need[colItem[q]]++;
+
+  // 入れない
+  x[col] = 0;
+  dfs(cost);
+  x[col] = -1;
+}
+
+
+//
+// Class SCPlns
+//
+
+// コンストラクタ
+SCPlns::SCPlns(SCPinstance &inst, int fm)
+  : tries(0), improved(0), freeMax(max(1, min(fm, LnsMaxCols / 2))),
+    repair(LnsMaxRows, LnsMaxCols, LnsNodeLimit), stamp(0)
+{
+  freed.reserve(LnsMaxCols);
+  subRows.reserve(LnsMaxRows);
+  demand.reserve(LnsMaxRows);
+  cands.reserve(LnsMaxCols);
+  chosen.reserve(LnsMaxCols);
+  reserve(inst);
+}
+
+
+// 行・列の数に合わせて印の配列を確保する
+void SCPlns::reserve(SCPinstance &inst)
+{
+  if ((int)rowSeen.size() != inst.numRows)
+  {
+    rowSeen.assign(inst.numRows, 0);
+    rowSub.assign(inst.numRows, 0);
+    rowLocal.assign(inst.numRows, 0);
+    queue.reserve(inst.numRows);
+  }
+  if ((int)colSeen.size() != inst.numColumns)
+  {
+    colSeen.assign(inst.numColumns, 0);
+    colCount.assign(inst.numColumns, 0);
+    colKeep.assign(inst.numColumns, 0);
+    others.reserve(inst.numColumns);
+  }
+}
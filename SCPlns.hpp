@@ -0,0 +1,235 @@
+//---------------------------------------------------------------------------
+// 大近傍探索（LNS）：解の一部を壊して，小さな分枝限定法で最適に直す
+//
+// 無作為な行から RowCovers と ColEntries をたどって近くにある解の列を外し，
+// 外した列の行が再び K回カバーされるように，それらの行をカバーする列の中から
+// 重みの和が最小の組を分枝限定法で選ぶ．外した列より軽くなれば入れ替える．
+// 部分問題の大きさには上限があり，作業用の配列は最初に確保する
+//---------------------------------------------------------------------------
+#pragma once
+
+#include "SCPv.hpp"
+#include "SCPkernel.hpp"
+#include <vector>
+#include <algorithm>
+
+//
+//  Class SCPrepair  小さな集合多重被覆問題の分枝限定法
+//
+//    min sum_j w_j x_j  s.t.  sum_{列jが行iをカバー} x_j >= d_i,  x_j in {0,1}
+//
+//  深さ優先で，残りの需要が大きく候補の少ない行を選び，その行の列を入れる・入れないで分ける．
+//  下界は「各行の需要の数だけ安い未定の列を足したもの」の行ごとの最大値
+//
+class SCPrepair
+{
+public:
+  SCPrepair(int maxRows, int maxCols, int nodeLimit);
+
+  // 部分問題を作る：clear の後に add_row で行を，add_column と add_entry で列を足し，
+  // 最後に finish を呼ぶ（番号は足した順）
+  void clear();
+  void add_row(int demand);
+  void add_column(int weight);
+  void add_entry(int row);                      // 最後に足した列が行 row をカバーする
+  void finish();
+
+  // 重みが upper 未満の解があれば最良のものの列を chosen に入れて true を返す
+  // 調べる節点の数は nodeLimit まで（超えたらそれまでの最良の解を返す）
+  bool solve(int upper, std::vector<int> &chosen);
+
+  int rows() const { return nRow; }
+  int cols() const { return nCol; }
+
+private:
+  int maxRows, maxCols, nodeLimit;
+  int nRow, nCol;
+
+  std::vector<int> w;                   // w[j]: 列jの重み
+  std::vector<int> need;                // need[i]: 行iの残りの需要（<= 0 なら満たされた）
+  std::vector<int> colStart, colItem;   // 列jの行は colItem[colStart[j] .. colStart[j+1]-1]
+  std::vector<int> rowStart, rowItem;   // 行iの列（重みの昇順）
+  std::vector<int> rowFill;             // finish の作業用
+  std::vector<signed char> x;           // x[j]: 1 入れる，0 入れない，-1 未定
+  std::vector<signed char> bestX;
+  int best;                             // これまでの最良の重み
+  long nodes;
+
+  void dfs(int cost);
+};
+
+
+// 部分問題の大きさの上限と分枝限定法の節点数の上限
+static const int LnsMaxRows = 64;
+static const int LnsMaxCols = 48;
+static const int LnsNodeLimit = 5000;
+
+
+//
+//  Class SCPlns  LNS の1回分（壊して直す）を行う
+//
+class SCPlns
+{
+public:
+  // freeMax: 1回に外す解の列の数の上限（LnsMaxCols / 2 まで）
+  SCPlns(SCPinstance &inst, int freeMax);
+
+  // 行・列の数が変わったら作業用の配列を確保し直す（探索の前に呼ぶ）
+  void reserve(SCPinstance &inst);
+
+  // 実行可能な cs の一部を壊して直す．軽くなれば cs を変えて（SCORE, SKCC, TIMES も
+  // DLL_com と同じように更新して）true を返す
+  template <typename CovT, typename Spec>
+  bool improve(SCPinstance &inst, SCPsolution<CovT> &cs, int iter, Rand &rnd);
+
+  long tries;                           // improve を呼んだ回数
+  long improved;                        // 軽くなった回数
+
+private:
+  int freeMax;
+  SCPrepair repair;
+
+  int stamp;
+  std::vector<int> rowSeen;             // 行をたどったら stamp
+  std::vector<int> rowSub;              // 部分問題の行なら stamp
+  std::vector<int> rowLocal;            // 部分問題での行の番号
+  std::vector<int> colSeen;             // 外した・候補にした列なら stamp
+  std::vector<int> colCount;            // 候補の列がカバーする需要のある部分問題の行の数
+  std::vector<int> colKeep;             // 直した解に残る列なら stamp
+
+  std::vector<int> queue;               // たどる行
+  std::vector<int> freed;               // 外す列
+  std::vector<int> subRows;             // 部分問題の行
+  std::vector<int> demand;              // 部分問題の行の需要
+  std::vector<int> others;              // 解にない候補の列
+  std::vector<int> cands;               // 部分問題の列（freed, others の順）
+  std::vector<int> chosen;
+};
+
+
+template <typename CovT, typename Spec>
+bool SCPlns::improve(SCPinstance &inst, SCPsolution<CovT> &cs, int iter, Rand &rnd)
+{
+  const int K = Spec::k(cs);
+  tries++;
+  stamp++;
+  queue.clear();
+  freed.clear();
+  subRows.clear();
+
+  // 無作為な行から幅優先でたどり，出会った解の列を外す
+  // 外した列の行が部分問題の行になるので，行の数が上限を超える列は外さない
+  int r0 = rnd(0, inst.numRows - 1);
+  queue.push_back(r0);
+  rowSeen[r0] = stamp;
+  for (size_t q = 0; q < queue.size() && (int)freed.size() < freeMax; q++)
+  {
+    for (int c : inst.RowCovers[queue[q]])
+    {
+      if (!cs.SOLUTION(c) || colSeen[c] == stamp) continue;
+
+      int add = 0;
+      for (int i : inst.ColEntries[c]) if (rowSub[i] != stamp) add++;
+      if ((int)subRows.size() + add > LnsMaxRows) continue;
+
+      colSeen[c] = stamp;
+      freed.push_back(c);
+      for (int i : inst.ColEntries[c])
+      {
+        if (rowSub[i] != stamp)
+        {
+          rowSub[i] = stamp;
+          rowLocal[i] = subRows.size();
+          subRows.push_back(i);
+        }
+        if (rowSeen[i] != stamp)
+        {
+          rowSeen[i] = stamp;
+          queue.push_back(i);
+        }
+      }
+      if ((int)freed.size() == freeMax) break;
+    }
+  }
+  if (freed.empty()) return false;
+
+  // 行の需要：外した列を除いたカバー数で足りない分
+  demand.assign(subRows.size(), 0);
+  for (size_t l = 0; l < subRows.size(); l++) demand[l] = K - cs.COVERED[subRows[l]];
+  for (int c : freed)
+    for (int i : inst.ColEntries[c]) demand[rowLocal[i]]++;
+
+  // 候補の列：需要のある行をカバーする解にない列．多ければ
+  // 重み / カバーする需要のある行の数 の小さいものを残す
+  others.clear();
+  for (size_t l = 0; l < subRows.size(); l++)
+  {
+    if (demand[l] <= 0) continue;
+    for (int c : inst.RowCovers[subRows[l]])
+    {
+      if (cs.SOLUTION(c)) continue;
+      if (colSeen[c] != stamp)
+      {
+        colSeen[c] = stamp;
+        colCount[c] = 0;
+        others.push_back(c);
+      }
+      colCount[c]++;
+    }
+  }
+
+  int room = LnsMaxCols - (int)freed.size();
+  if ((int)others.size() > room)
+  {
+    std::nth_element(others.begin(), others.begin() + room, others.end(),
+                     [&](int a, int b) {
+                       return (long)cs.Weight(a) * colCount[b] < (long)cs.Weight(b) * colCount[a];
+                     });
+    others.resize(room);
+  }
+
+  cands.clear();
+  cands.insert(cands.end(), freed.begin(), freed.end());
+  cands.insert(cands.end(), others.begin(), others.end());
+
+  // 部分問題を作って解く
+  int upper = 0;
+  for (int c : freed) upper += cs.Weight(c);
+
+  repair.clear();
+  for (size_t l = 0; l < subRows.size(); l++) repair.add_row(demand[l]);
+  for (int c : cands)
+  {
+    repair.add_column(cs.Weight(c));
+    for (int i : inst.ColEntries[c])
+      if (rowSub[i] == stamp) repair.add_entry(rowLocal[i]);
+  }
+  repair.finish();
+
+  if (!repair.solve(upper, chosen)) return false;
+
+  // 入れ替える：先に新しい列を入れてから，残らない外した列を削除する
+  for (int j : chosen)
+  {
+    int c = cands[j];
+    colKeep[c] = stamp;
+    if (cs.SOLUTION(c)) continue;
+
+    add_column_update<CovT, Spec>(inst, cs, c);
+    update_SKCC(inst, cs, c);
+    cs.SKCC(c) = 0;
+    cs.TIMES(c) = iter;
+  }
+  for (int c : freed)
+  {
+    if (colKeep[c] == stamp) continue;
+
+    remove_column_update<CovT, Spec>(inst, cs, c);
+    cs.TIMES(c) = iter;
+    cs.SKCC(c) = 0;
+    update_SKCC(inst, cs, c);
+  }
+
+  improved++;
+  return true;
+}
@@ -0,0 +1,79 @@
+#include "SCPteam.hpp"
+using namespace std;
+
+
+// 眠る前に仕事を待つ回数．run は探索の中で続けて呼ばれるので，
+// すぐ眠らずにしばらく待つ方が起こす手間がかからない
+static const int SpinCount = 4000;
+
+
+// コンストラクタ
+SCPteam::SCPteam(int n_)
+  : n(n_ < 1 ? 1 : n_), epoch(0), pending(0), quit(false), job(NULL), arg(NULL)
+{
+  for (int t = 1; t < n; t++) workers.push_back(thread(&SCPteam::loop, this, t));
+}
+
+
+// デストラクタ
+SCPteam::~SCPteam()
+{
+  {
+    lock_guard<mutex> lk(m);
+    quit = true;
+  }
+  wake.notify_all();
+  for (thread& th : workers) th.join();
+}
+
+
+// worker t の処理：epoch が変わるたびに job(t) を実行する
+void SCPteam::loop(int t)
+{
+  unsigned seen = 0;
+
+  while (true)
+  {
+    int spin = 0;
+    while (epoch.load(memory_order_acquire) == seen && !quit.load() && spin < SpinCount)
+    {
+      this_thread::yield();
+      spin++;
+    }
+
+    if (epoch.load(memory_order_acquire) == seen && !quit.load())
+    {
+      unique_lock<mutex> lk(m);
+      wake.wait(lk, [&]() { return epoch.load() != seen || quit.load(); });
+    }
+    if (quit.load()) return;
+
+    seen = epoch.load(memory_order_acquire);
+    job(arg, t);
+    pending.fetch_sub(1, memory_order_release);
+  }
+}
+
+
+// fn(a, t) を全てのスレッドで実行する
+void SCPteam::run_job(void (*fn)(const void*, int), const void* a)
+{
+  if (n == 1)
+  {
+    fn(a, 0);
+    return;
+  }
+
+  job = fn;
+  arg = a;
+  pending.store(n - 1, memory_order_relaxed);
+  {
+    lock_guard<mutex> lk(m);
+    epoch.fetch_add(1, memory_order_release);
+  }
+  wake.notify_all();
+
+  fn(a, 0);
+
+  while (pending.load(memory_order_acquire) > 0) this_thread::yield();
+}
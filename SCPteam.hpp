@@ -0,0 +1,45 @@
+//---------------------------------------------------------------------------
+// 探索の中で使うスレッドの組
+// 1回の探索の中の細かい並列処理（スコアの更新など）のために，スレッドを
+// 作ったままにしておき，run のたびに起こして同じ処理を分担させる．
+//---------------------------------------------------------------------------
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class SCPteam
+{
+public:
+  // 呼び出し側のスレッドを含めて n 個のスレッドで分担する
+  explicit SCPteam(int n);
+  ~SCPteam();
+
+  int size() const { return n; }
+
+  // f(t) を t = 0..size()-1 について並列に呼び，全て終わるまで待つ
+  // t = 0 は呼び出し側のスレッドで実行する
+  // （std::function に包むとヒープを確保することがあるので，関数ポインタで渡す）
+  template <typename F>
+  void run(const F &f) { run_job(&call<F>, &f); }
+
+private:
+  int n;
+  std::vector<std::thread> workers;
+  std::mutex m;
+  std::condition_variable wake;
+  std::atomic<unsigned> epoch;          // run のたびに増える
+  std::atomic<int> pending;             // まだ終わっていない worker の数
+  std::atomic<bool> quit;
+  void (*job)(const void*, int);
+  const void* arg;
+
+  template <typename F>
+  static void call(const void* f, int t) { (*(const F*)f)(t); }
+
+  void run_job(void (*fn)(const void*, int), const void* a);
+  void loop(int t);
+};
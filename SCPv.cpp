@@ -3,6 +3,85 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cerrno>
+
+//
+//
+//  Class SCPlists
+//
+//
+
+// リストiの末尾に x を足す
+// リストの後ろが空いていなければ Item の末尾へ移してから足す
+void SCPlists::append(int i, int x)
+{
+  Span& p = Pos[i];
+
+  if (p.e != Item.size())
+  {
+    std::size_t len = p.e - p.b;
+    std::size_t nb = Item.size();
+
+    Item.resize(nb + len);
+    std::copy(Item.begin() + p.b, Item.begin() + p.e, Item.begin() + nb);
+    Garbage += len;
+    p.b = nb;
+    p.e = nb + len;
+  }
+
+  Item.push_back(x);
+  p.e++;
+
+  if (Garbage > Item.size() / 2) compact();
+}
+
+
+// リストiから x を1つ取り除く（順序は保つ）
+bool SCPlists::erase(int i, int x)
+{
+  Span& p = Pos[i];
+  std::vector<int>::iterator b = Item.begin() + p.b, e = Item.begin() + p.e;
+  std::vector<int>::iterator it = std::find(b, e, x);
+
+  if (it == e) return false;
+
+  std::copy(it + 1, e, it);
+  p.e--;
+  Garbage++;
+  return true;
+}
+
+
+// リストiを空にする
+void SCPlists::clear_list(int i)
+{
+  Garbage += Pos[i].e - Pos[i].b;
+  Pos[i].e = Pos[i].b;
+}
+
+
+// 空きをなくして Item をリストの順に詰め直す
+void SCPlists::compact()
+{
+  std::vector<int> item;
+  item.reserve(nnz());
+
+  for (Span& p : Pos)
+  {
+    std::size_t nb = item.size();
+    item.insert(item.end(), Item.begin() + p.b, Item.begin() + p.e);
+    p.b = nb;
+    p.e = item.size();
+  }
+
+  Item.swap(item);
+  Garbage = 0;
+}
+
+// End SCPlists
+
 
 //
 //
@@ -10,131 +89,563 @@
 //
 //
 
-// コンストラクタ
-SCPinstance::SCPinstance(std::string instance_file)
+//
+//  インスタンスファイル用の整数読み取り
+//  大きなブロックで read() し，数字を直接解釈する（fscanf より速い）
+//  ファイル名が .gz で終わるときは gzip -dc の出力をパイプで読む
+//  （シェルを通さずに gzip を起動するので，ファイル名に何が含まれていてもよい）
+//
+class IntReader
 {
-  FILE *SourceFile = fopen(instance_file.c_str(), "r");
+  FILE* fp;
+  pid_t child;                  // gzip のプロセス（パイプでなければ -1）
+  std::vector<char> buf;
+  std::size_t pos, len;
 
-  if (SourceFile == NULL) throw DataException();
-  else
+  // バッファを補充する．ファイルの終わりなら false
+  bool fill()
   {
-    int R, C, cost;
-    fscanf(SourceFile, "%d", &R);
-    fscanf(SourceFile, "%d", &C);
-    numRows = R;
-    numColumns = C;
+    ssize_t n = read(fileno(fp), buf.data(), buf.size());
+    pos = 0;
+    len = (n > 0) ? (std::size_t)n : 0;
+    return len > 0;
+  }
 
-    int* nCov = new int [numColumns];
-    int* idx = new int [numColumns];
-    for (int j = 0; j < numColumns; j++) {
-      nCov[j] = 0;
-      idx[j] = 0;
-    }
+  // gzip -dc file を起動し，その標準出力を開く
+  void open_gzip(const std::string& file)
+  {
+    int fd[2];
+    if (::pipe(fd) != 0) return;
 
-    for (int j = 0; j < numColumns; j++)
+    child = fork();
+    if (child < 0)
     {
-      std::vector<int> nn;
-      Neighborhood.push_back(nn);
+      ::close(fd[0]);
+      ::close(fd[1]);
+      return;
     }
-
-    // read costs
-    for(int j = 0; j < C; j++)
+    if (child == 0)
     {
-      fscanf(SourceFile, "%d", &cost);
-      Weight.push_back(cost);
+      dup2(fd[1], STDOUT_FILENO);
+      ::close(fd[0]);
+      ::close(fd[1]);
+      execlp("gzip", "gzip", "-dc", "--", file.c_str(), (char*)NULL);
+      _exit(127);
     }
 
-    // ファイルから各行の情報を読む
-    int CoverNo, CoverID;
-    std::vector<int> cov;
+    ::close(fd[1]);
+    fp = fdopen(fd[0], "r");
+    if (fp == NULL) ::close(fd[0]);
+  }
 
+public:
+  IntReader(const std::string& file) : fp(NULL), child(-1), buf(1 << 20), pos(0), len(0)
+  {
+    if (file.size() > 3 && file.compare(file.size() - 3, 3, ".gz") == 0)
+      open_gzip(file);
+    else
+      fp = fopen(file.c_str(), "r");
+  }
 
-    for(int i = 0;  i < numRows; i++)
-    {
-      if (fscanf(SourceFile, "%d", &CoverNo) == EOF)
-        throw (DataException());
+  ~IntReader() { close(false); }
 
-      cov.clear();
-      for(int j = 0; j < CoverNo; j++)
-      {
-        if (fscanf(SourceFile,"%d", &CoverID) == EOF)
-          throw (DataException());
+  // ファイルを閉じる．gzip が失敗していたら（壊れた .gz など）false
+  // drain なら gzip の残りの出力を読み切ってから閉じる（途中で閉じると gzip が SIGPIPE で終わる）
+  bool close(bool drain = true)
+  {
+    if (fp != NULL && child > 0 && drain)
+      while (fill()) ;
+    if (fp != NULL) fclose(fp);
+    fp = NULL;
 
-        if (CoverID >= 1 && CoverID <= numColumns)
-        {
-          cov.push_back(CoverID - 1);
-          nCov[CoverID - 1]++;
-        }
-        else
-          throw (DataException());
-      }
+    bool ok = true;
+    if (child > 0)
+    {
+      int status = 0;
+      pid_t r;
+      do r = waitpid(child, &status, 0); while (r < 0 && errno == EINTR);
+      ok = (r == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+      child = -1;
+    }
+    return ok;
+  }
+
+  bool is_open() const { return fp != NULL; }
 
-      RowCovers.push_back(cov);
+  // 次の整数を x に入れる．ファイルの終わりなら false
+  bool next(int& x)
+  {
+    // 空白などを読み飛ばす
+    for (;;)
+    {
+      if (pos == len && !fill()) return false;
+      char ch = buf[pos];
+      if ((ch >= '0' && ch <= '9') || ch == '-') break;
+      pos++;
     }
-    // ファイルの読み込み終了
 
-    // 列の情報を作成
-    for (int j = 0; j < numColumns; ++j) {
-      std::vector<int> c(nCov[j]);
-      ColEntries.push_back(c);
+    bool neg = false;
+    if (buf[pos] == '-') { neg = true; pos++; }
+
+    long v = 0;
+    for (;;)
+    {
+      if (pos == len && !fill()) break;
+      unsigned d = (unsigned)(buf[pos] - '0');
+      if (d > 9) break;
+      v = v * 10 + d;
+      pos++;
     }
+    x = (int)(neg ? -v : v);
+    return true;
+  }
+};
+
+
+// コンストラクタ
+// 行の情報はファイルから直接 RowCovers (CSR) に読み込み，
+// 列の情報はそれを転置して作る
+SCPinstance::SCPinstance(std::string instance_file, RenumberMode mode)
+{
+  IntReader in(instance_file);
+  MarkStamp = 0;
+
+  if (!in.is_open()) throw DataException();
 
-    for (int i = 0; i < numRows; i++)
+  int R, C, cost;
+  if (!in.next(R) || !in.next(C) || R < 0 || C <= 0) throw DataException();
+  numRows = R;
+  numColumns = C;
+
+  // read costs
+  Weight.resize(numColumns);
+  for (int j = 0; j < numColumns; j++)
+  {
+    if (!in.next(cost)) throw DataException();
+    Weight[j] = cost;
+  }
+
+  // ファイルから各行の情報を読む
+  int CoverNo, CoverID;
+  RowCovers.clear();
+
+  for (int i = 0; i < numRows; i++)
+  {
+    if (!in.next(CoverNo) || CoverNo < 0) throw DataException();
+
+    RowCovers.new_list();
+
+    for (int j = 0; j < CoverNo; j++)
     {
-      for (int c : RowCovers[i]) {
-        ColEntries[c][idx[c]] = i;
-        idx[c]++;
-      }
+      if (!in.next(CoverID)) throw DataException();
+
+      if (CoverID >= 1 && CoverID <= numColumns)
+        RowCovers.push(CoverID - 1);
+      else
+        throw DataException();
     }
-    // 列の情報の作成終了
-    delete [] nCov;
-    delete [] idx;
   }
+  if (!in.close()) throw DataException();
+  RowCovers.Item.shrink_to_fit();
+  // ファイルの読み込み終了
+
+  // 各行の列を昇順にする（スコアの更新を列の範囲で分けるため）
+  for (int i = 0; i < numRows; i++)
+    std::sort(RowCovers.Item.begin() + RowCovers.Pos[i].b,
+              RowCovers.Item.begin() + RowCovers.Pos[i].e);
+
+  // 列の情報を作成
+  build_columns();
 
+  // 番号の付け替え
+  renumber(mode);
+  Order = mode;
 
   // 近傍を作る
+  build_neighborhood();
+
+  maxRowDegree = 0;
+  for (int i = 0; i < numRows; i++)
+  {
+    if (maxRowDegree < RowCovers[i].size()) maxRowDegree = RowCovers[i].size();
+  }
+
+  // 密度の計算
+  Density = (double)RowCovers.nnz() / ((double)numColumns * numRows);
+}
+
+// End: コンストラクタ
+
+
+// 部分インスタンスのコンストラクタ
+SCPinstance::SCPinstance(const SCPinstance &parent, const std::vector<int> &rows,
+                         const std::vector<int> &cols, const std::vector<int> &colIndex)
+{
+  MarkStamp = 0;
+  numRows = rows.size();
+  numColumns = cols.size();
+  Order = parent.Order;
+
+  Weight.resize(numColumns);
+  OrigCol.resize(numColumns);
+  for (int j = 0; j < numColumns; j++)
+  {
+    Weight[j] = parent.Weight[cols[j]];
+    OrigCol[j] = parent.OrigCol[cols[j]];
+  }
+
+  RowCovers.clear();
+  OrigRow.resize(numRows);
+  for (int i = 0; i < numRows; i++)
+  {
+    RowCovers.new_list();
+    for (int c : parent.RowCovers[rows[i]]) RowCovers.push(colIndex[c]);
+    std::sort(RowCovers.Item.begin() + RowCovers.Pos[i].b,
+              RowCovers.Item.begin() + RowCovers.Pos[i].e);
+    OrigRow[i] = parent.OrigRow[rows[i]];
+  }
+  RowCovers.Item.shrink_to_fit();
+
+  build_columns();
+  build_neighborhood();
+
+  maxRowDegree = 0;
+  for (int i = 0; i < numRows; i++)
+  {
+    if (maxRowDegree < RowCovers[i].size()) maxRowDegree = RowCovers[i].size();
+  }
+
+  Density = numRows > 0 ? (double)RowCovers.nnz() / ((double)numColumns * numRows) : 0.0;
+}
+
+
+// RowCovers を転置して ColEntries を作る
+// 各列の行は番号の昇順に並ぶ
+void SCPinstance::build_columns()
+{
+  std::vector<std::size_t> start(numColumns + 1, 0);
+  for (int i = 0; i < numRows; i++)
+  {
+    for (int c : RowCovers[i]) start[c + 1]++;
+  }
+  for (int j = 0; j < numColumns; j++) start[j + 1] += start[j];
+
+  ColEntries.clear();
+  ColEntries.Pos.resize(numColumns);
+  for (int j = 0; j < numColumns; j++)
+    ColEntries.Pos[j].b = ColEntries.Pos[j].e = start[j];
+
+  ColEntries.Item.assign(start[numColumns], 0);
+  for (int i = 0; i < numRows; i++)
+  {
+    for (int c : RowCovers[i]) ColEntries.Item[ColEntries.Pos[c].e++] = i;
+  }
+}
+
+
+// 列jの近傍（jと同じ行をカバーする j 以外の列）を作る
+// 重複は印の配列で取り除く（列の並びは最初に出会った順）
+void SCPinstance::build_neighborhood()
+{
+  std::vector<int> mark(numColumns, -1);
+  Neighborhood.clear();
+
   for (int j = 0; j < numColumns; ++j)
   {
+    Neighborhood.new_list();
+    mark[j] = j;
     for (int r : ColEntries[j])
     {
       for (int c : RowCovers[r])
       {
-        if (c != j) Neighborhood[j].push_back(c);
+        if (mark[c] != j)
+        {
+          mark[c] = j;
+          Neighborhood.push(c);
+        }
       }
     }
   }
+  Neighborhood.Item.shrink_to_fit();
+}
 
-  for (int j = 0; j < numColumns; ++j)
+
+// 行・列の番号を付け替える
+// 近い番号の行・列が同じ行をカバーするように並べ，
+// スコア更新で RowCovers[r] をたどるときのキャッシュミスを減らす
+void SCPinstance::renumber(RenumberMode mode)
+{
+  std::vector<int> rowOrder(numRows), colOrder(numColumns);   // 新しい番号 -> 元の番号
+  for (int i = 0; i < numRows; i++) rowOrder[i] = i;
+  for (int j = 0; j < numColumns; j++) colOrder[j] = j;
+
+  if (mode == RENUMBER_DEGREE)
+  {
+    std::stable_sort(rowOrder.begin(), rowOrder.end(),
+                     [&](int a, int b) { return RowCovers[a].size() < RowCovers[b].size(); });
+    std::stable_sort(colOrder.begin(), colOrder.end(),
+                     [&](int a, int b) { return ColEntries[a].size() < ColEntries[b].size(); });
+  }
+  else if (mode == RENUMBER_RCM)
   {
-    std::sort(Neighborhood[j].begin(), Neighborhood[j].end());
-    Neighborhood[j].erase(std::unique(Neighborhood[j].begin(), Neighborhood[j].end()), Neighborhood[j].end());
+    // 頂点 0..numRows-1 が行，numRows.. が列
+    int N = numRows + numColumns;
+    auto degree = [&](int v) {
+      return (v < numRows) ? RowCovers[v].size() : ColEntries[v - numRows].size();
+    };
+
+    std::vector<int> byDegree(N);
+    for (int v = 0; v < N; v++) byDegree[v] = v;
+    std::stable_sort(byDegree.begin(), byDegree.end(),
+                     [&](int a, int b) { return degree(a) < degree(b); });
+
+    std::vector<char> visited(N, 0);
+    std::vector<int> order;
+    std::vector<int> nbr;
+    order.reserve(N);
+
+    // 連結成分ごとに次数最小の頂点から幅優先探索
+    for (int s : byDegree)
+    {
+      if (visited[s]) continue;
+      visited[s] = 1;
+      size_t head = order.size();
+      order.push_back(s);
+
+      while (head < order.size())
+      {
+        int v = order[head++];
+        nbr.clear();
+        if (v < numRows)
+        {
+          for (int c : RowCovers[v])
+            if (!visited[numRows + c]) nbr.push_back(numRows + c);
+        }
+        else
+        {
+          for (int r : ColEntries[v - numRows])
+            if (!visited[r]) nbr.push_back(r);
+        }
+        std::stable_sort(nbr.begin(), nbr.end(),
+                         [&](int a, int b) { return degree(a) < degree(b); });
+        for (int u : nbr)
+        {
+          visited[u] = 1;
+          order.push_back(u);
+        }
+      }
+    }
+    std::reverse(order.begin(), order.end());
+
+    int ri = 0, ci = 0;
+    for (int v : order)
+    {
+      if (v < numRows) rowOrder[ri++] = v;
+      else colOrder[ci++] = v - numRows;
+    }
   }
-  // 近傍の生成終了
 
-  
+  OrigRow = rowOrder;
+  OrigCol = colOrder;
+  if (mode == RENUMBER_NONE) return;
 
-  
-  // 簡単な方法でデータの正しさを確認
-  long Sum1 = 0, Sum2 = 0;
-  for (int i = 0; i < numRows; i++) Sum1 += RowCovers[i].size();
-  for (int j = 0; j < numColumns; j++) Sum2 += ColEntries[j].size();
+  std::vector<int> newRow(numRows), newCol(numColumns);      // 元の番号 -> 新しい番号
+  for (int i = 0; i < numRows; i++) newRow[rowOrder[i]] = i;
+  for (int j = 0; j < numColumns; j++) newCol[colOrder[j]] = j;
 
-  //Incorrect Source File!
-  if (Sum1 != Sum2)  throw (DataException());
+  SCPlists rc;
+  std::vector<int> w(numColumns);
 
-  // 密度の計算
-  Density = (float)Sum1/(numColumns * numRows);
-}
+  rc.Item.reserve(RowCovers.nnz());
+  for (int i = 0; i < numRows; i++)
+  {
+    rc.new_list();
+    for (int c : RowCovers[rowOrder[i]]) rc.push(newCol[c]);
+    std::sort(rc.Item.begin() + rc.Pos[i].b, rc.Item.end());
+  }
+  for (int j = 0; j < numColumns; j++) w[j] = Weight[colOrder[j]];
 
-// End: コンストラクタ
+  std::swap(RowCovers, rc);
+  Weight.swap(w);
+  build_columns();
+}
 
 
 // デストラクタ
 //SCPinstance::~SCPinstance()
 // End: デストラクタ
 
+// インスタンスが使っているメモリの概算（バイト）
+std::size_t SCPinstance::memory_bytes() const
+{
+  const SCPlists* lists[] = { &RowCovers, &ColEntries, &Neighborhood };
+  std::size_t bytes = sizeof(SCPinstance);
+
+  for (const SCPlists* L : lists)
+    bytes += L->Pos.capacity() * sizeof(SCPlists::Span) + L->Item.capacity() * sizeof(int);
+  bytes += (Weight.capacity() + OrigRow.capacity() + OrigCol.capacity() + Mark.capacity()) * sizeof(int);
+
+  return bytes;
+}
+
+// インスタンスのハッシュ（FNV-1a を 32ビットずつ）
+std::uint64_t SCPinstance::fingerprint() const
+{
+  std::uint64_t h = 14695981039346656037ULL;
+  auto mix = [&](int v) {
+    h ^= (std::uint32_t)v;
+    h *= 1099511628211ULL;
+  };
+
+  mix(numRows);
+  mix(numColumns);
+  for (int i = 0; i < numRows; i++)
+  {
+    mix(RowCovers[i].size());
+    for (int c : RowCovers[i]) mix(c);
+  }
+  for (int w : Weight) mix(w);
+  for (int i : OrigRow) mix(i);
+  for (int j : OrigCol) mix(j);
+
+  return h;
+}
+
+// 行を追加する．cols: 行をカバーする列
+// RowCovers, ColEntries に行を足し，cols の列どうしを近傍にする
+int SCPinstance::add_row(const std::vector<int>& cols)
+{
+  int r = numRows;
+
+  for (int c : cols)
+    if (c < 0 || c >= numColumns) throw DataException();
+
+  std::vector<int> sorted(cols);
+  std::sort(sorted.begin(), sorted.end());
+
+  // 同じ列が2回あると K回のカバーに2回数えられるので受け付けない
+  if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) throw DataException();
+
+  RowCovers.new_list();
+  for (int c : sorted)
+  {
+    RowCovers.push(c);
+    ColEntries.append(c, r);
+  }
+
+  // 近傍の更新：列 a の近傍に印を付け，まだない列を足す
+  if (Mark.size() != (std::size_t)numColumns) Mark.assign(numColumns, 0);
+
+  for (int a : cols)
+  {
+    int stamp = ++MarkStamp;
+    for (int c : Neighborhood[a]) Mark[c] = stamp;
+    Mark[a] = stamp;
+    for (int b : cols)
+    {
+      if (Mark[b] != stamp)
+      {
+        Mark[b] = stamp;
+        Neighborhood.append(a, b);
+      }
+    }
+  }
+
+  numRows++;
+  OrigRow.push_back(r);
+  if (maxRowDegree < (int)cols.size()) maxRowDegree = cols.size();
+  Density = (double)RowCovers.nnz() / ((double)numColumns * numRows);
+
+  return r;
+}
+
+
+// 列cを削除する
+// 番号を詰めると解の配列も作り直しになるので，番号は残して空の列にする
+void SCPinstance::remove_column(int c)
+{
+  for (int r : ColEntries[c]) RowCovers.erase(r, c);
+  for (int n : Neighborhood[c]) Neighborhood.erase(n, c);
+
+  ColEntries.clear_list(c);
+  Neighborhood.clear_list(c);
+
+  Density = (double)RowCovers.nnz() / ((double)numColumns * numRows);
+}
+
 // End SCPinstance
 
+
+//
+//
+// Class SCPinstanceCache
+//
+//
+
+SCPinstanceCache::SCPinstanceCache(std::size_t budget_, RenumberMode mode_)
+  : budget(budget_), used(0), mode(mode_)
+{
+}
+
+
+// ファイルのインスタンスを返す．なければ読み込んで保持する
+// 読み込みの間は鍵を外すので，他のファイルを求めるスレッドは待たない
+std::shared_ptr<SCPinstance> SCPinstanceCache::get(const std::string& file)
+{
+  std::promise<std::shared_ptr<SCPinstance> > promise;
+  std::shared_future<std::shared_ptr<SCPinstance> > other;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = index.find(file);
+    if (it != index.end())
+    {
+      // 最後に使ったものとして先頭に移す
+      lru.splice(lru.begin(), lru, it->second);
+      return it->second->second;
+    }
+
+    // 他のスレッドが読み込み中ならそれを待つ．そうでなければこのスレッドが読み込む
+    auto lt = loading.find(file);
+    if (lt != loading.end()) other = lt->second;
+    else loading[file] = promise.get_future().share();
+  }
+  if (other.valid()) return other.get();        // 読み込みに失敗していたら例外
+
+  std::shared_ptr<SCPinstance> inst;
+  try {
+    inst = std::make_shared<SCPinstance>(file, mode);
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+    std::lock_guard<std::mutex> lock(mtx);
+    loading.erase(file);
+    throw;
+  }
+  std::size_t bytes = inst->memory_bytes();
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // 上限を超えるなら古いものから捨てる（新しいものは必ず入れる）
+    while (!lru.empty() && used + bytes > budget)
+    {
+      used -= lru.back().second->memory_bytes();
+      index.erase(lru.back().first);
+      lru.pop_back();
+    }
+
+    lru.push_front(Entry(file, inst));
+    index[file] = lru.begin();
+    used += bytes;
+    loading.erase(file);
+  }
+  promise.set_value(inst);
+
+  return inst;
+}
+
+// End SCPinstanceCache
+
 //
 //
 // Class SCPsolution
@@ -142,7 +653,8 @@ SCPinstance::SCPinstance(std::string instance_file)
 //
 
 // コンストラクタ
-SCPsolution::SCPsolution(const SCPinstance &inst, int k)
+template <typename CovT>
+SCPsolution<CovT>::SCPsolution(const SCPinstance &inst, int k)
 {
   //instance = inst;
 
@@ -152,59 +664,130 @@ SCPsolution::SCPsolution(const SCPinstance &inst, int k)
   num_Cover = 0;
   totalWeight = 0;
 
+  Col.resize(nCol);
   for (int j = 0; j < nCol; ++j)
   {
-    SOLUTION.push_back(0);
+    Col[j].score = 0;
+    Col[j].weight = inst.Weight[j];
+    Col[j].times = 0;
+    Col[j].sol = 0;
+    Col[j].skcc = (inst.ColEntries[j].size() > 0);   // 削除された列は選ばない
   }
 
   for (int i = 0; i < nRow; i++)
   {
     COVERED.push_back(0);
+    COST.push_back(1);
   }
+
+  CS.reserve(nCol);
+  rebuild_candidates();
 }
 
 
 // デストラクタ
-SCPsolution::~SCPsolution()
+template <typename CovT>
+SCPsolution<CovT>::~SCPsolution()
 {
 }
 
 
-// 候補解を初期化
-void SCPsolution::initialize(SCPinstance &inst)
+// 候補解を空にし，探索用のデータも初期値に戻す
+template <typename CovT>
+void SCPsolution<CovT>::initialize(SCPinstance &inst)
 {
   num_Cover = 0;
+  totalWeight = 0;
 
   for (int j = 0; j < nCol; ++j)
   {
-    SOLUTION[j] = 0;
+    Col[j].score = 0;
+    Col[j].times = 0;
+    Col[j].sol = 0;
+    Col[j].skcc = (inst.ColEntries[j].size() > 0);   // 削除された列は選ばない
   }
 
   for (int i = 0; i < nRow; ++i)
   {
     COVERED[i] = 0;
+    COST[i] = 1;
   }
 
   CS.clear();
+  rebuild_candidates();
 }
 
 
-// CSに列cを追加する
-void SCPsolution::add_column(SCPinstance &inst, int c)
+// Cand と CandPos を SOLUTION から作り直す
+template <typename CovT>
+void SCPsolution<CovT>::rebuild_candidates()
+{
+  Cand.clear();
+  Cand.reserve(nCol);
+  CandPos.assign(nCol, -1);
+  for (int j = 0; j < nCol; ++j)
+  {
+    if (Col[j].sol) continue;
+    CandPos[j] = Cand.size();
+    Cand.push_back(j);
+  }
+}
+
+
+// 列cを CS に入れ，Cand から除く
+template <typename CovT>
+void SCPsolution<CovT>::enter_column(int c)
 {
-  if (SOLUTION[c])
+  if (Col[c].sol)
   {
     printf("Column %d has already contained in CS\n", c);
     exit(1);
   }
 
-  totalWeight += inst.Weight[c];
+  totalWeight += Col[c].weight;
 
-  SOLUTION[c] = 1;
+  Col[c].sol = 1;
 
   // CSに列cを追加
   CS.push_back(c);
 
+  // Cand から列cを除く（最後の列を空いた位置に移す）
+  int p = CandPos[c];
+  int last = Cand.back();
+  Cand[p] = last;
+  CandPos[last] = p;
+  Cand.pop_back();
+  CandPos[c] = -1;
+} // End enter_column
+
+
+// 列cを CS から除き，Cand に入れる
+template <typename CovT>
+void SCPsolution<CovT>::leave_column(int c)
+{
+  if (Col[c].sol == 0)
+  {
+    printf("Column %d is not contained in CS\n", c);
+    exit(1);
+  }
+
+  totalWeight -= Col[c].weight;
+
+  Col[c].sol = 0;
+
+  // CSから列cを削除
+  CS.erase(remove(CS.begin(), CS.end(), c), CS.end());
+  CandPos[c] = Cand.size();
+  Cand.push_back(c);
+} // End leave_column
+
+
+// CSに列cを追加する
+template <typename CovT>
+void SCPsolution<CovT>::add_column(SCPinstance &inst, int c)
+{
+  enter_column(c);
+
   for (int r : inst.ColEntries[c])
   {
     COVERED[r]++;
@@ -217,20 +800,10 @@ void SCPsolution::add_column(SCPinstance &inst, int c)
 
 
 // CSから列cを削除する
-void SCPsolution::remove_column(SCPinstance &inst, int c)
+template <typename CovT>
+void SCPsolution<CovT>::remove_column(SCPinstance &inst, int c)
 {
-  if (SOLUTION[c] == 0)
-  {
-    printf("Column %d is not contained in CS\n", c);
-    exit(1);
-  }
-
-  totalWeight -= inst.Weight[c];
-
-  SOLUTION[c] = 0;
-
-  // CSから列cを削除
-  CS.erase(remove(CS.begin(), CS.end(), c), CS.end());
+  leave_column(c);
 
   for (int r : inst.ColEntries[c])
   {
@@ -243,13 +816,55 @@ void SCPsolution::remove_column(SCPinstance &inst, int c)
 } // End remove_column
 
 
+// インスタンスに追加された行rを反映する
+// SCORE は DLL_com と同じ定義（解の列はK回しかカバーされない行の COST を引き，
+// 解にない列はK回カバーされていない行の COST を足す）に合わせる
+template <typename CovT>
+void SCPsolution<CovT>::add_row(SCPinstance &inst, int r)
+{
+  int cov = 0;
+  for (int c : inst.RowCovers[r])
+    if (Col[c].sol) cov++;
+
+  nRow++;
+  COVERED.push_back(cov);
+  COST.push_back(1);
+  if (cov >= K) num_Cover++;
+
+  for (int c : inst.RowCovers[r])
+  {
+    if (Col[c].sol && cov == K) Col[c].score -= COST[r];
+    else if (!Col[c].sol && cov < K) Col[c].score += COST[r];
+  }
+} // End add_row
+
+
+// 列cのコストの変更を反映する
+template <typename CovT>
+void SCPsolution<CovT>::set_weight(int c, int w)
+{
+  if (Col[c].sol) totalWeight += w - Col[c].weight;
+  Col[c].weight = w;
+} // End set_weight
+
+
 // CSの中身を表示
-void SCPsolution::print_solution()
+template <typename CovT>
+void SCPsolution<CovT>::print_solution(SCPinstance &inst)
 {
-  sort(CS.begin(), CS.end());
-  for (int c : CS)
+  std::vector<int> cols;
+  for (int c : CS) cols.push_back(inst.OrigCol[c]);
+
+  sort(cols.begin(), cols.end());
+  for (int c : cols)
   {
     printf("%d ", c + 1);
   }
   printf("\n");
 } // End print_solution
+
+
+// COVERED の型ごとに実体化
+template class SCPsolution<std::uint8_t>;
+template class SCPsolution<std::uint16_t>;
+template class SCPsolution<int>;
@@ -11,6 +11,77 @@
 #include <vector>
 #include <string>
 #include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+
+//
+//  リストの集まりを圧縮行格納（CSR）形式で持つクラス
+//  L[i] は i 番目のリストの範囲を返すので，for (int x : L[i]) で走査できる
+//
+//  各リストは Item の連続した範囲 [Pos[i].b, Pos[i].e) にある．
+//  append で後ろに詰められないリストは Item の末尾へ移すので，
+//  インスタンスを作り直さずに要素を足したり消したりできる．
+//  移した後の空きは Garbage に数え，多くなったら compact で詰める．
+//
+class SCPlists
+{
+public:
+  struct Span { std::size_t b, e; };
+
+  std::vector<Span> Pos;            // リストiは Item[Pos[i].b] .. Item[Pos[i].e - 1]
+  std::vector<int> Item;
+  std::size_t Garbage;              // どのリストにも属さない Item の数
+
+  struct Range
+  {
+    const int *b, *e;
+    const int* begin() const { return b; }
+    const int* end() const { return e; }
+    int size() const { return (int)(e - b); }
+    int operator[](int k) const { return b[k]; }
+  };
+
+  SCPlists() : Garbage(0) {}
+
+  Range operator[](int i) const
+  {
+    return Range{Item.data() + Pos[i].b, Item.data() + Pos[i].e};
+  }
+  int size() const { return (int)Pos.size(); }
+  std::size_t nnz() const { return Item.size() - Garbage; }
+
+  // 作るとき：new_list() で空のリストを末尾に作り，push(x) でそのリストに足す
+  void clear() { Pos.clear(); Item.clear(); Garbage = 0; }
+  void new_list() { Pos.push_back(Span{Item.size(), Item.size()}); }
+  void push(int x) { Item.push_back(x); Pos.back().e++; }
+
+  // リストiの末尾に x を足す
+  void append(int i, int x);
+
+  // リストiから x を1つ取り除く（順序は保つ）．なければ false
+  bool erase(int i, int x);
+
+  // リストiを空にする
+  void clear_list(int i);
+
+  // 空きをなくして Item をリストの順に詰め直す
+  void compact();
+};
+
+
+// 読み込み時の行・列の番号の付け替え方（メモリアクセスの局所性のため）
+enum RenumberMode
+{
+  RENUMBER_NONE,                // ファイルの順のまま
+  RENUMBER_DEGREE,              // 次数の昇順
+  RENUMBER_RCM                  // 行-列の2部グラフの reverse Cuthill-McKee 順
+};
+
 
 //
 //
@@ -23,25 +94,119 @@ public:
   int     numRows;             // The num of rows
   int     numColumns;          // The num of columns
   double  Density;             // The density of the matrix
+  int     maxRowDegree;        // 行をカバーする列の数の最大値（COVERED の型の選択に使う）
 
 public:
-  SCPinstance(std::string SourceFile);
+  SCPinstance(std::string SourceFile, RenumberMode mode = RENUMBER_NONE);
+
+  // 部分インスタンス：parent の行 rows と列 cols からなるインスタンスを作る
+  // colIndex[j] は parent の列jの新しい番号（rows の行をカバーする列は全て cols にあること）
+  // OrigRow, OrigCol は parent のもの（ファイル上の番号）を引き継ぐ
+  SCPinstance(const SCPinstance &parent, const std::vector<int> &rows,
+              const std::vector<int> &cols, const std::vector<int> &colIndex);
   ~SCPinstance() {}
 
-  std::vector<std::vector<int> > RowCovers;	// 行をカバーする列のリスト
-  std::vector<std::vector<int> > ColEntries;	// 列がカバーする行のリスト
-  std::vector<std::vector<int> > Neighborhood;  // 列がカバーする行のリスト
+  SCPlists RowCovers;                           // 行をカバーする列のリスト（列番号の昇順）
+  SCPlists ColEntries;                          // 列がカバーする行のリスト
+  SCPlists Neighborhood;                        // 列と同じ行をカバーする列のリスト
   std::vector<int> Weight;                      // 列のコスト
+
+  // 番号を付け替えたときの元の番号（0始まり）．付け替えなければ恒等写像
+  std::vector<int> OrigRow;                     // OrigRow[i]: 行iのファイル上の番号
+  std::vector<int> OrigCol;                     // OrigCol[j]: 列jのファイル上の番号
+  RenumberMode Order;                           // 読み込み時の番号の付け替え方（部分インスタンスは親のもの）
+
+  // インスタンスが使っているメモリの概算（バイト）
+  std::size_t memory_bytes() const;
+
+  // 行・列の数，各行の列，コスト，元の番号から作るハッシュ（FNV-1a）
+  // チェックポイントが同じインスタンスのものか確かめるのに使う
+  std::uint64_t fingerprint() const;
+
+  // インスタンスの変更（ファイルを読み直さず，変わった所だけ更新する）
+  // 行を追加する．cols: 行をカバーする列．追加した行の番号を返す
+  // 範囲外の列・重複した列があれば DataException
+  int add_row(const std::vector<int>& cols);
+
+  // 列cを削除する．番号は残し，どの行もカバーしない列にする
+  void remove_column(int c);
+
+  // 列cのコストを w にする
+  void set_weight(int c, int w) { Weight[c] = w; }
+
+private:
+  std::vector<int> Mark;                        // add_row の作業用
+  int MarkStamp;
+
+
+  // RowCovers から ColEntries を作る
+  void build_columns();
+
+  // ColEntries, RowCovers から Neighborhood を作る
+  void build_neighborhood();
+
+  // RowCovers, ColEntries, Weight の行・列の番号を付け替える
+  void renumber(RenumberMode mode);
 };
 
 class DataException {};
 
 
+//
+//
+//  Class SCPinstanceCache  読み込んだインスタンスをファイル名で保持するクラス
+//
+//  バッチで同じファイルが何度も現れるときに読み込み直さないようにする．
+//  合計が budget バイトを超えたら最後に使ったのが古いものから捨てる．
+//  shared_ptr で返すので，捨てられても使用中のインスタンスは消えない．
+//  get は複数のスレッドから呼んでよい．読み込みは鍵を外して行い，同じファイルを
+//  同時に求めたスレッドは読み込み中の shared_future を待つ（読み込むのは1回だけ）．
+//
+class SCPinstanceCache
+{
+public:
+  SCPinstanceCache(std::size_t budget, RenumberMode mode = RENUMBER_NONE);
+
+  // ファイルのインスタンスを返す．なければ読み込む
+  std::shared_ptr<SCPinstance> get(const std::string& file);
+
+private:
+  typedef std::pair<std::string, std::shared_ptr<SCPinstance> > Entry;
+
+  std::size_t budget;                           // メモリの上限
+  std::size_t used;                             // 保持しているインスタンスのメモリ
+  RenumberMode mode;                            // 読み込むときの番号の付け替え方
+  std::list<Entry> lru;                         // 先頭が最後に使ったもの
+  std::map<std::string, std::list<Entry>::iterator> index;
+  std::map<std::string, std::shared_future<std::shared_ptr<SCPinstance> > > loading;
+  std::mutex mtx;
+};
+
+
+//
+//  列ごとの探索用データ
+//  get_add_rule / get_remove_rule の走査で一緒に読む値を1つにまとめ，
+//  1列あたり16バイト（1キャッシュラインに4列）に収める
+//
+struct SCPcolumn
+{
+  int score;                    // SCORE: 列のスコア
+  int weight;                   // 列のコスト（inst.Weight の写し）
+  int times;                    // TIMES: 最後に追加・削除した反復
+  std::uint8_t sol;             // SOLUTION: 候補解に含まれれば1
+  std::uint8_t skcc;            // SKCC: 追加してよければ1
+};
+
+
 //
 //
 //  Class SCPsolution SCPの候補解を管理するクラス
 //
+//  CovT: COVERED の要素の型．COVERED[i] は行iの次数を超えないので，
+//  インスタンスの maxRowDegree に合わせて uint8_t / uint16_t / int を選ぶ
+//  （SCPv.cpp で3つとも実体化している）
 //
+template <typename CovT>
 class SCPsolution
 {
 public:
@@ -52,26 +217,31 @@ public:
   int     totalWeight;
 
   std::vector<int> CS;                   // CS: 候補解（列番号のリスト）
-  std::vector<int> SOLUTION;             // SOLUTION[j] = 1: 列jが候補解に含まれる
-  std::vector<int> COVERED;              // COVERED[i]: 行iがカバーされている回数
+  std::vector<SCPcolumn> Col;            // Col[j]: 列jの探索用データ
+  std::vector<CovT> COVERED;             // COVERED[i]: 行iがカバーされている回数
+  std::vector<int> COST;                 // COST[i]: 行iの重み（スコアの計算に使う）
   int num_Cover;                         // カバーされた行の数
 
+  std::vector<int> Cand;                 // Cand: CS に含まれない列（BMS で候補を選ぶ配列，順序は不定）
+  std::vector<int> CandPos;              // CandPos[j]: 列jの Cand での位置（CS にあれば -1）
+
+  // 列jのデータへのアクセス
+  std::uint8_t& SOLUTION(int j) { return Col[j].sol; }   // 1: 列jが候補解に含まれる
+  std::uint8_t& SKCC(int j)     { return Col[j].skcc; }
+  int& SCORE(int j)             { return Col[j].score; }
+  int& TIMES(int j)             { return Col[j].times; }
+  int Weight(int j) const       { return Col[j].weight; }
+
 public:
   // インスタンス，K, 行重みしきい値, oblivious_ratio
   SCPsolution(const SCPinstance &pData, int k);
   ~SCPsolution();
 
-  // 候補解を初期化
+  // 候補解を空にし，探索用のデータも初期値に戻す
   void initialize(SCPinstance &pData);
 
-  // CSに含まれない列から最大スコアのものを選んで返す
-  //int get_column_maxscore(SCPinstance &pData, Rand& rnd);
-
-  // CSに含まれない列から最大スコアのものを選んで返す
-  //int get_column_BMS(SCPinstance &pData, Rand& rnd);
-
-  // CSに含まれない列から alpha * 最大スコア 以上のものを選んで返す
-  //int get_column_grasp(SCPinstance &pData, double alpha, Rand& rnd);
+  // Cand と CandPos を SOLUTION から作り直す（Col を直接書き換えたとき）
+  void rebuild_candidates();
 
   // CSに列cを追加する
   void add_column(SCPinstance &pData, int c);
@@ -79,6 +249,29 @@ public:
   // CSから列cを削除する
   void remove_column(SCPinstance &pData, int c);
 
-  // CSの中身を表示
-  void print_solution();
+  // 列cを CS, Cand, totalWeight に入れる・外す（COVERED は変えない）
+  // add_column / remove_column と，行の更新を自分で行う SCPkernel の部品が使う
+  void enter_column(int c);
+  void leave_column(int c);
+
+  // インスタンスに追加された行rを反映する（COVERED, COST, SCORE を更新）
+  void add_row(SCPinstance &pData, int r);
+
+  // 列cのコストの変更を反映する
+  void set_weight(int c, int w);
+
+  // CSの中身をファイル上の列番号で表示
+  void print_solution(SCPinstance &pData);
 };
+
+
+// COVERED の型の種類
+enum CoverWidth { COVER_U8, COVER_U16, COVER_INT };
+
+// インスタンスの最大行次数から COVERED の型を決める
+inline CoverWidth cover_width(const SCPinstance &inst)
+{
+  if (inst.maxRowDegree <= UINT8_MAX) return COVER_U8;
+  if (inst.maxRowDegree <= UINT16_MAX) return COVER_U16;
+  return COVER_INT;
+}
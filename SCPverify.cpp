@@ -0,0 +1,159 @@
+#include "SCPverify.hpp"
+#include <algorithm>
+#include <thread>
+#include <limits>
+using namespace std;
+
+
+// 1スレッドで数える列数の目安（非ゼロ要素の数ではなく列の数）
+static const int VerifyBlock = 4096;
+
+
+// コンストラクタ
+SCPverifier::SCPverifier(SCPinstance &pData, int nThreads)
+  : inst(pData), numThreads(max(1, nThreads)), MarkStamp(0)
+{
+}
+
+
+// 行 [b, e) のカバー数の最小値
+// 8本の最小値を別々に持つので，最適化してコンパイルすれば（CFLAGS に -O2 を足すなど）
+// コンパイラが SIMD の min にまとめられる（既定の CFLAGS は最適化しない）
+static int min_cover(const int* cov, int b, int e)
+{
+  int m[8];
+  for (int l = 0; l < 8; l++) m[l] = numeric_limits<int>::max();
+
+  int r = b;
+  for (; r + 8 <= e; r += 8)
+    for (int l = 0; l < 8; l++) m[l] = min(m[l], cov[r + l]);
+  for (; r < e; r++) m[0] = min(m[0], cov[r]);
+
+  for (int l = 1; l < 8; l++) m[0] = min(m[0], m[l]);
+  return m[0];
+}
+
+
+// Count[0] に cols のカバー数を数え，result に結果を入れる
+// 範囲外・重複した列は ids の同じ位置の番号で報告する
+void SCPverifier::count(int K, const vector<int> &cols, const vector<int> &ids,
+                        VerifyResult &result)
+{
+  int nRow = inst.numRows;
+  int nCol = inst.numColumns;
+
+  // 範囲外・重複した列を除き，重みを足す
+  if ((int)Mark.size() < nCol) Mark.resize(nCol, 0);
+  if (++MarkStamp == 0)
+  {
+    fill(Mark.begin(), Mark.end(), 0);
+    MarkStamp = 1;
+  }
+
+  buf.clear();
+  for (size_t i = 0; i < cols.size(); i++)
+  {
+    int c = cols[i];
+    if (c < 0 || c >= nCol || Mark[c] == MarkStamp)
+    {
+      result.badColumns.push_back(ids[i]);
+      continue;
+    }
+    Mark[c] = MarkStamp;
+    result.weight += inst.Weight[c];
+    buf.push_back(c);
+  }
+
+  // 列をブロックに分けてスレッドごとに数える
+  int nt = min(numThreads, max(1, (int)buf.size() / VerifyBlock));
+  if ((int)Count.size() < nt) Count.resize(nt);
+
+  auto add = [&](int t) {
+    vector<int>& cov = Count[t];
+    cov.assign(nRow, 0);
+    size_t b = buf.size() * t / nt, e = buf.size() * (t + 1) / nt;
+    for (size_t i = b; i < e; i++)
+      for (int r : inst.ColEntries[buf[i]]) cov[r]++;
+  };
+
+  // 行をブロックに分けて足し合わせ，最小値を求める
+  vector<int> mins(nt);
+  auto reduce = [&](int t) {
+    int b = (long)nRow * t / nt, e = (long)nRow * (t + 1) / nt;
+    int* c0 = Count[0].data();
+    for (int s = 1; s < nt; s++)
+    {
+      const int* cs = Count[s].data();
+      for (int r = b; r < e; r++) c0[r] += cs[r];
+    }
+    mins[t] = min_cover(c0, b, e);
+  };
+
+  if (nt == 1)
+  {
+    add(0);
+    reduce(0);
+  }
+  else
+  {
+    vector<thread> th;
+    for (int t = 1; t < nt; t++) th.push_back(thread(add, t));
+    add(0);
+    for (thread& x : th) x.join();
+
+    th.clear();
+    for (int t = 1; t < nt; t++) th.push_back(thread(reduce, t));
+    reduce(0);
+    for (thread& x : th) x.join();
+  }
+
+  result.minCover = nRow > 0 ? *min_element(mins.begin(), mins.end()) : K;
+
+  // 足りない行は最小値が K 未満のときだけ探す
+  if (result.minCover < K)
+  {
+    const vector<int>& cov = Count[0];
+    for (int r = 0; r < nRow; r++)
+      if (cov[r] < K) result.underRows.push_back(r);
+  }
+
+  result.feasible = result.underRows.empty() && result.badColumns.empty();
+}
+
+
+// 内部の列番号の解を検証する
+VerifyResult SCPverifier::verify(int K, const vector<int> &cols)
+{
+  VerifyResult result;
+  count(K, cols, cols, result);
+  return result;
+}
+
+
+// ファイル上の列番号（1から）の解を検証する
+VerifyResult SCPverifier::verify_original(int K, const vector<int> &cols)
+{
+  // 番号の対応は最初に使うときに作る
+  // 部分インスタンスの OrigCol は親の番号なので，列の数より大きいことがある
+  if (Internal.empty())
+  {
+    int n = 0;
+    for (int o : inst.OrigCol) n = max(n, o + 1);
+    Internal.assign(n, -1);
+    for (int c = 0; c < inst.numColumns; c++) Internal[inst.OrigCol[c]] = c;
+  }
+
+  vector<int> in;
+  in.reserve(cols.size());
+  for (int j : cols)
+    in.push_back(j >= 1 && j <= (int)Internal.size() ? Internal[j - 1] : -1);
+
+  VerifyResult result;
+  count(K, in, cols, result);
+
+  // 行の番号をファイル上のものに戻す
+  for (int& r : result.underRows) r = inst.OrigRow[r] + 1;
+  sort(result.underRows.begin(), result.underRows.end());
+
+  return result;
+}
@@ -0,0 +1,57 @@
+//---------------------------------------------------------------------------
+// 集合Kカバー問題の解の検証
+// 外から与えられた多数の解を確かめるためのもの．作業用の配列は SCPverifier が持ち，
+// 検証のたびには確保しない．列が多いときは列をブロックに分けてスレッドごとに
+// 行のカバー数を数え，行ごとに足し合わせながら最小値を求める．
+//---------------------------------------------------------------------------
+#pragma once
+
+#include "SCPv.hpp"
+#include <vector>
+
+//
+//  検証の結果
+//
+struct VerifyResult
+{
+  bool feasible;                // 全ての行が K回以上カバーされ，列が正しい
+  int weight;                   // 列の重みの和
+  int minCover;                 // 行のカバー数の最小値
+  std::vector<int> underRows;   // K回未満しかカバーされない行（内部の番号）
+  std::vector<int> badColumns;  // 範囲外・重複した列（与えられた番号のまま）
+
+  VerifyResult() : feasible(false), weight(0), minCover(0) {}
+};
+
+
+//
+//
+//  Class SCPverifier  解を検証するクラス
+//
+//
+class SCPverifier
+{
+public:
+  // numThreads > 1 なら大きな解はスレッドで分けて数える
+  SCPverifier(SCPinstance &pData, int numThreads = 1);
+
+  // 内部の列番号の解 cols を検証する
+  VerifyResult verify(int K, const std::vector<int> &cols);
+
+  // ファイル上の列番号（1から）の解 cols を検証する
+  // underRows はファイル上の行番号（1から）で返す
+  VerifyResult verify_original(int K, const std::vector<int> &cols);
+
+private:
+  SCPinstance &inst;
+  int numThreads;
+  std::vector<std::vector<int> > Count;         // Count[t][r]: スレッドtで数えた行rのカバー数
+  std::vector<int> Mark;                        // 重複した列を見つける
+  int MarkStamp;
+  std::vector<int> Internal;                    // Internal[j]: ファイル上の列jの内部の番号
+  std::vector<int> buf;                         // 番号を直した列
+
+  // Count[0] に cols のカバー数を数え，result に結果を入れる
+  void count(int K, const std::vector<int> &cols, const std::vector<int> &ids,
+             VerifyResult &result);
+};
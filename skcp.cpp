@@ -0,0 +1,1129 @@
+#include "skcp.hpp"
+#include "SCPlagrangian.hpp"
+#include "SCPverify.hpp"
+#include "SCPkernel.hpp"
+#include "SCPteam.hpp"
+#include "SCPcomponent.hpp"
+#include "SCPlns.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <fstream>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <chrono>
+using namespace std;
+
+
+#ifdef SKCP_COUNT_ALLOC
+// 確認用（make DEFS=-DSKCP_COUNT_ALLOC）：スレッドごとにヒープの確保を数える
+static thread_local long AllocCount = 0;
+
+void* operator new(std::size_t n)
+{
+  AllocCount++;
+  void* p = malloc(n ? n : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, std::size_t) noexcept { free(p); }
+
+// 生きている間にこのスレッドでヒープを確保したら止める
+struct NoAllocCheck
+{
+  long start;
+  bool active;
+
+  NoAllocCheck(bool a) : start(AllocCount), active(a) {}
+  ~NoAllocCheck()
+  {
+    if (active && AllocCount != start)
+    {
+      fprintf(stderr, "DLL_com: %ld heap allocations in the search loop\n", AllocCount - start);
+      abort();
+    }
+  }
+};
+#endif
+
+
+// 成分が報告する前の重み（全ての成分が報告するまで目標に達しないように大きくする）
+static const long PartUnknownWeight = 1L << 40;
+
+// 連結成分に分けて解くときの目標の重み（Solver::solve_parts）
+// 成分は最良解の重みを報告し，和が target 以下になったら全ての成分を止める
+// 探索の前に全ての成分の初期解を報告するので，探索中の和はいつも全体の実行可能解の重み
+struct PartTarget
+{
+  int target;
+  std::chrono::steady_clock::time_point start;
+  std::vector<long> weight;             // weight[p]: 成分pが報告した重み（成分pのスレッドだけが書く）
+  std::atomic<long> total;              // weight の和
+  std::atomic<bool> reached;
+  double seconds;                       // start から達するまでの秒数（達したスレッドが書く）
+
+  PartTarget(int t, int numParts)
+    : target(t), start(std::chrono::steady_clock::now()), weight(numParts, PartUnknownWeight),
+      total(PartUnknownWeight * numParts), reached(false), seconds(0) {}
+
+  // 成分 p の最良解の重みが w になった
+  void report(int p, int w)
+  {
+    long d = w - weight[p];
+    weight[p] = w;
+    if (total.fetch_add(d) + d <= target && !reached.exchange(true))
+      seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+};
+
+
+// DLL_com の制御
+struct DLLcontrol
+{
+  int max_iter;                 // 反復回数
+  int target;                   // 最良解の重みが target 以下になったらやめる
+  SCPlagrangian* lag;           // コアを広げるときに乗数を更新する
+  SCPcore* core;                // NULL でなければ追加する列はコアから選ぶ
+  int refresh;                  // コアを広げる間隔
+  int first_iter;               // 最初の反復．>1 ならチェックポイントから続ける（CS, CSbest はそのまま）
+  int first_lns;                // 前に LNS を行った反復（チェックポイントから続けるときは保存した値）
+  int checkpoint_every;         // この反復回数ごとに checkpoint を呼ぶ（0 なら呼ばない）
+  function<void(int, int)> checkpoint;  // 反復 iter を始める前の状態（と前の LNS の反復）を保存する
+  int bms;                      // >0 なら列を bms 個の候補から選ぶ（core があれば追加はコアから）
+  SCPteam* team;                // NULL でなければ大きなスコアの更新を分担する
+  int parallel_work;            // 調べる要素がこれ以上のときだけ team を使う
+  int parallel_rows;            // K回カバーされない行がこれ以上なら重みの更新を team で分ける
+  SCPlns* lns;                  // NULL でなければ実行可能解の一部を壊して直す（LNS）
+  int lns_every;                // 前の LNS からこの反復回数が過ぎたら，実行可能になったときに行う
+  int lns_tries;                // 1回の LNS で壊して直す回数
+  PartTarget* part_target;      // NULL でなければ最良解の重みを報告し，全体で目標に達したらやめる
+  int part_id;                  // part_target に報告するときの成分の番号
+
+  DLLcontrol(int m)
+    : max_iter(m), target(0), lag(NULL), core(NULL), refresh(0),
+      first_iter(1), first_lns(0), checkpoint_every(0), bms(0), team(NULL), parallel_work(0),
+      parallel_rows(0), lns(NULL), lns_every(0), lns_tries(0), part_target(NULL), part_id(0) {}
+};
+
+
+// 列cのスコアの更新で調べる要素の数（cの行の RowCovers の長さの和）
+static long update_work(SCPinstance& inst, int c)
+{
+  long n = 0;
+  for (int r : inst.ColEntries[c]) n += inst.RowCovers[r].size();
+  return n;
+}
+
+
+// 列cを追加してスコアを更新する（resetCost は add_column_update と同じ）
+// ふつうは add_column_update で列の行を1回だけ走査する
+// 調べる要素が多ければ，列番号の範囲で分けて ctl.team で行う（範囲ごとに書く列が違うので競合しない）
+template <typename CovT, typename Spec>
+void add_move(SCPinstance& inst, SCPsolution<CovT>& cs, int c, int resetCost, const DLLcontrol& ctl)
+{
+  const int K = Spec::k(cs);
+  if (ctl.team == NULL || update_work(inst, c) < ctl.parallel_work)
+  {
+    add_column_update<CovT, Spec>(inst, cs, c, resetCost);
+    return;
+  }
+
+  cs.add_column(inst, c);
+
+  int sc = 0;
+  for (int r : inst.ColEntries[c])
+    if (cs.COVERED[r] == K) sc -= cs.COST[r];
+  cs.SCORE(c) = sc;
+
+  long n = inst.numColumns, T = ctl.team->size();
+  ctl.team->run([&](int t) {
+    add_update_score_range<CovT, Spec>(inst, cs, c, (int)(n * t / T), (int)(n * (t + 1) / T));
+  });
+
+  // K回カバーされた行の COST を1に戻してスコア再計算
+  for (int r : inst.ColEntries[c])
+  {
+    if (cs.COST[r] > resetCost && cs.COVERED[r] == K)
+    {
+      cs.COST[r] = 1;
+      for (int rc : inst.RowCovers[r])
+        cs.SCORE(rc) = compute_score<CovT, Spec>(inst, cs, rc);
+    }
+  }
+}
+
+
+// 列cを削除してスコアを更新する
+template <typename CovT, typename Spec>
+void remove_move(SCPinstance& inst, SCPsolution<CovT>& cs, int c, const DLLcontrol& ctl)
+{
+  const int K = Spec::k(cs);
+  if (ctl.team == NULL || update_work(inst, c) < ctl.parallel_work)
+  {
+    remove_column_update<CovT, Spec>(inst, cs, c);
+    return;
+  }
+
+  cs.remove_column(inst, c);
+
+  int sc = 0;
+  for (int r : inst.ColEntries[c])
+    if (cs.COVERED[r] < K) sc += cs.COST[r];
+  cs.SCORE(c) = sc;
+
+  long n = inst.numColumns, T = ctl.team->size();
+  ctl.team->run([&](int t) {
+    remove_update_score_range<CovT, Spec>(inst, cs, c, (int)(n * t / T), (int)(n * (t + 1) / T));
+  });
+}
+
+
+// 重みの更新：K回カバーされていない行の COST を1増やし，その行を含む解にない列の SCORE を1増やす
+// そのような行が ctl.parallel_rows 以上あれば team で2段階に分ける
+//   1. 行を区間に分け，各スレッドが自分の区間の該当行の COST を増やして uncovered[t] に集める
+//   2. 列番号の範囲で分け，各スレッドが集めた全ての行について自分の範囲の列の SCORE を増やす
+// uncovered はスレッドごとの作業用（呼び出し側で持ち回り，確保し直さない）
+template <typename CovT, typename Spec>
+void weight_update(SCPinstance& inst, SCPsolution<CovT>& cs, const DLLcontrol& ctl,
+                   vector<vector<int> >& uncovered)
+{
+  const int K = Spec::k(cs);
+  if (ctl.team == NULL || inst.numRows - cs.num_Cover < ctl.parallel_rows)
+  {
+    for (int r = 0; r < inst.numRows; r++)
+    {
+      if (cs.COVERED[r] < K)
+      {
+        cs.COST[r]++;
+        for (int rc : inst.RowCovers[r])
+        {
+          if (!cs.SOLUTION(rc)) cs.SCORE(rc)++;
+        }
+      }
+    }
+    return;
+  }
+
+  long T = ctl.team->size();
+  long nRow = inst.numRows, nCol = inst.numColumns;
+  if ((long)uncovered.size() < T) uncovered.resize(T);
+
+  ctl.team->run([&](int t) {
+    vector<int>& rows = uncovered[t];
+    rows.clear();
+    for (int r = (int)(nRow * t / T); r < (int)(nRow * (t + 1) / T); r++)
+    {
+      if (cs.COVERED[r] < K)
+      {
+        cs.COST[r]++;
+        rows.push_back(r);
+      }
+    }
+  });
+
+  ctl.team->run([&](int t) {
+    int lo = (int)(nCol * t / T), hi = (int)(nCol * (t + 1) / T);
+    for (long s = 0; s < T; s++)
+    {
+      for (int r : uncovered[s])
+      {
+        SCPlists::Range R = inst.RowCovers[r];
+        for (const int* p = lower_bound(R.begin(), R.end(), lo); p != R.end() && *p < hi; ++p)
+          if (!cs.SOLUTION(*p)) cs.SCORE(*p)++;
+      }
+    }
+  });
+}
+
+
+// CS に入っている実行可能解から ctl.max_iter 回まで探索し，最良解を CSbest に入れる
+// 最良解の重みが ctl.target 以下になったら（下界に達したなど）そこでやめる
+// ctl.core があれば追加する列はコアから選び，ctl.refresh 回ごとにコアを広げる
+// ctl.part_target があれば最良解の重みを報告し，全ての成分の和が目標に達したらやめる
+// 最後に行った反復を返す
+template <typename CovT, typename Spec>
+int DLL_com(SCPinstance& inst,
+            SCPsolution<CovT>& CS,
+            SCPsolution<CovT>& CSbest,
+            vector<int>& Freq,
+            const DLLcontrol& ctl,
+            SCPworkspace& ws,
+            Rand& rnd)
+{
+  const int k = Spec::k(CS);
+  int max_iter = ctl.max_iter;
+  int target = ctl.target;
+  SCPlagrangian* lag = ctl.lag;
+  SCPcore* core = ctl.core;
+  int refresh = ctl.refresh;
+  PartTarget* part_target = ctl.part_target;
+
+  if (ctl.first_iter <= 1)
+  {
+    CSbest = CS;
+    if (part_target != NULL) part_target->report(ctl.part_id, CSbest.totalWeight);
+    if (CSbest.totalWeight <= target) return 0;
+
+    for (int c : CS.CS) CS.TIMES(c) = 1;
+
+    for (int c = 0; c < inst.numColumns; c++)
+    {
+      CS.SCORE(c) = 0;
+      if (CS.SOLUTION(c))
+      {
+        for (int r : inst.ColEntries[c])
+          if (CS.COVERED[r] == k) CS.SCORE(c) -= CS.COST[r];
+      }
+    }
+  }
+  else if (CSbest.totalWeight <= target) return ctl.first_iter - 1;
+
+  int remove_col;
+  int last_lns = ctl.first_lns;
+  if (ctl.team != NULL) ws.reserve_rows(inst, ctl.team->size());
+
+#ifdef SKCP_COUNT_ALLOC
+  // ここから後は確保しないことを確かめる（チェックポイントとコアの更新は確保するので除く）
+  NoAllocCheck noalloc(core == NULL && ctl.checkpoint_every == 0);
+#endif
+
+  for (int iter = max(ctl.first_iter, 1); iter <= max_iter; iter++)
+  {
+    // 他の成分とあわせて目標に達した
+    if (part_target != NULL && part_target->reached) return iter - 1;
+
+    // チェックポイント（再開した反復では書き直さない）
+    if (ctl.checkpoint_every > 0 && iter % ctl.checkpoint_every == 0 && iter != ctl.first_iter)
+      ctl.checkpoint(iter, last_lns);
+
+    // コアを広げる：最良解の重みを上界にして乗数を更新し，列を追加
+    if (core != NULL && refresh > 0 && iter % refresh == 0)
+    {
+      lag->compute(CSbest.totalWeight, 50);
+      core->expand();
+    }
+
+    // cout << "Iter: " << iter;
+    // cout << " " << CSbest.totalWeight << " " << CS.totalWeight << " " << CS.num_Cover << " " << CS.CS.size() << " ";
+
+
+
+    // 実行可能解が見つかったら更新
+    if (CS.num_Cover == inst.numRows) {
+      // LNS：解の一部を分枝限定法で直す（軽くなったときだけ CS が変わる）
+      if (ctl.lns != NULL && iter - last_lns >= ctl.lns_every)
+      {
+        for (int t = 0; t < ctl.lns_tries; t++) ctl.lns->improve<CovT, Spec>(inst, CS, iter, rnd);
+        last_lns = iter;
+      }
+
+      CSbest = CS;
+      if (part_target != NULL) part_target->report(ctl.part_id, CSbest.totalWeight);
+      if (CSbest.totalWeight <= target) return iter;
+      remove_col = ctl.bms > 0 ? get_remove_rule_bms<CovT, Spec>(inst, CS, 0, ctl.bms, ws, rnd)
+                               : get_remove_rule<CovT, Spec>(inst, CS, 0, ws, rnd);
+
+      // cout << " Remove " << remove_col << "(" << (double)CS.SCORE(remove_col) / inst.Weight[remove_col] << ") ";
+
+      // 列を削除して update SCORE
+      remove_move<CovT, Spec>(inst, CS, remove_col, ctl);
+      CS.TIMES(remove_col) = iter;
+      //Freq[remove_col]++;
+
+      // update SKCC
+      CS.SKCC(remove_col) = 0;
+      update_SKCC(inst, CS, remove_col);
+      // end update SKCC
+
+      // cout << " continue" << endl;
+      continue;
+    }
+
+    // CS が実行可能でない場合
+    // 1列削除する
+    remove_col = ctl.bms > 0 ? get_remove_rule_bms<CovT, Spec>(inst, CS, iter, ctl.bms, ws, rnd)
+                             : get_remove_rule<CovT, Spec>(inst, CS, iter, ws, rnd);
+    // cout << " Remove " << remove_col << "(" << (double)CS.SCORE(remove_col) / inst.Weight[remove_col] << ") ";
+    remove_move<CovT, Spec>(inst, CS, remove_col, ctl);
+    CS.TIMES(remove_col) = iter;
+    //Freq[remove_col]++;
+
+    // update SKCC
+    CS.SKCC(remove_col) = 0;
+    update_SKCC(inst, CS, remove_col);
+    // end update SKCC
+
+    int add_col;
+    //bool brk_flag = false;
+
+    // 実行可能になるまで追加
+    while (CS.num_Cover < inst.numRows) {
+      if (ctl.bms > 0 && core == NULL) add_col = get_add_rule_bms<CovT, Spec>(inst, CS, ctl.bms, ws, rnd);
+      else add_col = get_add_rule<CovT, Spec>(inst, CS, core ? &core->Columns : NULL, ws, rnd);
+
+      if (CS.totalWeight + CS.Weight(add_col) >= CSbest.totalWeight)
+      {
+        // 追加した結果が悪い解ならやめてやり直す
+        //brk_flag = true;
+        // cout << "Add " << add_col << " Break ";
+	break;
+      }
+      else
+      {
+        // cout << "Add " << add_col << "(" << (double)CS.SCORE(add_col) / inst.Weight[add_col] << ") ";
+        // Araki: COST reset
+        // add_colを追加してK回カバーされた行の COST が max_iter/10 を超えていれば1に戻す
+        //（スコアの更新と同じ走査で行う）
+        add_move<CovT, Spec>(inst, CS, add_col, max_iter / 10, ctl);
+
+        update_SKCC(inst, CS, add_col);
+        CS.SKCC(add_col) = 0;
+
+        CS.TIMES(add_col) = iter;
+        Freq[add_col]++;
+      }
+
+      // update COST and SCORE
+      weight_update<CovT, Spec>(inst, CS, ctl, ws.uncovered);
+
+      // Check
+      // for (int c = 0; c < inst.numColumns; c++) {
+      //   int sc = compute_score(inst, CS, c);
+      //   if (sc != CS.SCORE(c)) {
+      //     printf("Col %d (%d) sc = %d, but SCORE[%d] = %d\n", c, CS.SOLUTION(c), sc, c, CS.SCORE(c));
+      //     exit(1);
+      //   }
+      // }
+
+    } // end while CS.num_Cover
+
+    // cout << endl;
+  } // End iter
+
+
+  // for (int c= 0; c < inst.numColumns; c++) {
+  //   cout << c << " ";
+  //   if (CSbest.SOLUTION(c)) cout << "+ ";
+  //   else cout << "  ";
+  //   cout << Freq[c] << endl;
+  // }
+
+  return max_iter;
+}
+
+
+
+// 列の集合 cols が全ての行を K回カバーし，重みが totalWeight か確認する
+bool check_solution(SCPinstance& inst, int K, const vector<int>& cols, int totalWeight)
+{
+  SCPverifier verifier(inst);
+  VerifyResult res = verifier.verify(K, cols);
+
+  if (!res.feasible) {
+    cout << "This is not a feasible solution." << endl;
+    return false;
+  }
+
+  if (res.weight != totalWeight) {
+    cout << "Wrong totalWeight." << endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+
+//
+//  チェックポイントのファイル
+//  "SKCPCKP3", 行数, 列数, K, sizeof(CovT), 番号の付け替え方, 反復回数の上限,
+//  下界を求めたときの上界, 次の反復, 前の LNS の反復, インスタンスのハッシュ, 乱数の状態,
+//  CS（重み, カバーした行数, 列, Col, COVERED, COST, Cand）, CSbest の列, Freq
+//  をこの順にそのまま（バイナリで）書く．同じ計算機で読むことが前提
+//  読むときはハッシュまでが今のインスタンスと設定に一致しなければ使わない
+//
+static const char CheckpointMagic[8] = {'S', 'K', 'C', 'P', 'C', 'K', 'P', '3'};
+static const int CheckpointHead = 9;
+
+template <typename T>
+static void put_array(FILE* fp, const vector<T>& v)
+{
+  int n = v.size();
+  fwrite(&n, sizeof(int), 1, fp);
+  if (n > 0) fwrite(v.data(), sizeof(T), n, fp);
+}
+
+template <typename T>
+static bool get_array(FILE* fp, vector<T>& v)
+{
+  int n;
+  if (fread(&n, sizeof(int), 1, fp) != 1 || n < 0) return false;
+  v.resize(n);
+  return n == 0 || fread(v.data(), sizeof(T), n, fp) == (size_t)n;
+}
+
+// 列の番号 cols が 0..n-1 の範囲にあり，重複しないか
+static bool distinct_columns(const vector<int>& cols, int n)
+{
+  vector<char> seen(n, 0);
+  for (int c : cols)
+  {
+    if (c < 0 || c >= n || seen[c]) return false;
+    seen[c] = 1;
+  }
+  return true;
+}
+
+
+
+//
+//
+// Class Solver
+//
+//
+
+// COVERED の型によらない部分
+class Solver::Engine
+{
+public:
+  Engine() : part_target(NULL), part_id(0) {}
+  virtual ~Engine() {}
+
+  // 成分として解くときの全体の目標と成分の番号（solve_parts が設定する）
+  PartTarget* part_target;
+  int part_id;
+
+  // warm から（NULL なら空から）貪欲法で実行可能解を作って探索する
+  // 最良解の重みと列を返す
+  virtual int run(const vector<int>* warm, const SolverOptions& opt, Rand& rnd,
+                  vector<int>& best, SolverStats& stats) = 0;
+
+  // run を2つに分けたもの：construct で貪欲法の解を作って重みを返し，
+  // run_constructed でその解から探索する（成分の初期解を先に揃えるのに使う）
+  virtual int construct(const vector<int>* warm, const SolverOptions& opt, Rand& rnd) = 0;
+  virtual int run_constructed(const SolverOptions& opt, Rand& rnd,
+                              vector<int>& best, SolverStats& stats) = 0;
+
+  // 探索中の解から探索を続ける
+  virtual int resume(const SolverOptions& opt, Rand& rnd,
+                     vector<int>& best, SolverStats& stats) = 0;
+
+  // チェックポイントを読み込み，保存した反復から探索を続ける
+  // ファイルが読めない・インスタンスや設定が違うときは DataException
+  virtual int restart(const std::string& file, const SolverOptions& opt, Rand& rnd,
+                      vector<int>& best, SolverStats& stats) = 0;
+
+  // 探索中の解を cols にする / 探索中の解の列を返す
+  virtual void load(const vector<int>& cols) = 0;
+  virtual const vector<int>& columns() = 0;
+
+  // インスタンスの変更を探索中の解に反映する
+  virtual void add_row(int r) = 0;              // inst に行rを追加した後に呼ぶ
+  virtual void remove_column(int c) = 0;        // inst から列cを削除する前に呼ぶ
+  virtual void set_weight(int c, int w) = 0;
+};
+
+
+// COVERED の型が CovT の実装．探索用の配列を持ち回る
+template <typename CovT>
+class EngineT : public Solver::Engine
+{
+  SCPinstance& inst;
+  SCPsolution<CovT> CS;
+  SCPsolution<CovT> CSbest;
+  SCPworkspace ws;              // 列の選択と貪欲法の作業用
+  vector<int> Freq;             // 列を追加した回数
+  std::unique_ptr<SCPteam> team;        // スコアの更新を分担するスレッド（opt.scoreThreads > 1）
+  std::unique_ptr<SCPlns> lns;          // LNS の作業用（opt.lnsEvery > 0）
+  std::chrono::steady_clock::time_point started;        // 解き始めた時刻（目標への到達時間用）
+  int lbUpper;                  // 下界を求めるときの上界（初期解の重み）
+
+public:
+  EngineT(SCPinstance& pData, int k)
+    : inst(pData), CS(pData, k), CSbest(pData, k),
+      ws(pData), Freq(pData.numColumns, 0), lbUpper(0)
+  {
+  }
+
+  int run(const vector<int>* warm, const SolverOptions& opt, Rand& rnd,
+          vector<int>& best, SolverStats& stats)
+  {
+    construct(warm, opt, rnd);
+    return run_constructed(opt, rnd, best, stats);
+  }
+
+  int construct(const vector<int>* warm, const SolverOptions& opt, Rand& rnd)
+  {
+    started = std::chrono::steady_clock::now();
+    fill(Freq.begin(), Freq.end(), 0);
+
+    if (warm != NULL) load(*warm);
+    else CS.initialize(inst);
+
+    complete(warm != NULL, opt, rnd);
+    return CS.totalWeight;
+  }
+
+  int run_constructed(const SolverOptions& opt, Rand& rnd,
+                      vector<int>& best, SolverStats& stats)
+  {
+    return search(1, opt, rnd, best, stats);
+  }
+
+  int resume(const SolverOptions& opt, Rand& rnd,
+             vector<int>& best, SolverStats& stats)
+  {
+    started = std::chrono::steady_clock::now();
+
+    // TIMES は前の探索の反復番号なので，新しい探索の禁止・最古の判定に使えるよう戻す
+    for (int c = 0; c < inst.numColumns; c++) CS.TIMES(c) = 0;
+    complete(true, opt, rnd);
+    return search(1, opt, rnd, best, stats);
+  }
+
+  int restart(const std::string& file, const SolverOptions& opt, Rand& rnd,
+              vector<int>& best, SolverStats& stats)
+  {
+    started = std::chrono::steady_clock::now();
+    int lastLns;
+    int iter = load_checkpoint(file, opt, rnd, lastLns);
+    if (iter <= 0) throw DataException();
+    return search(iter, opt, rnd, best, stats, lastLns);
+  }
+
+  // 反復 iter を始める前の状態を file に書く（lastLns: 前に LNS を行った反復，
+  // hash: inst.fingerprint()．下界を求めたときの上界 lbUpper も書く）
+  // 途中で止まっても前のファイルが壊れないように，別名で書いてから置き換える
+  void save_checkpoint(const std::string& file, int iter, int lastLns, std::uint64_t hash,
+                       const SolverOptions& opt, Rand& rnd)
+  {
+    std::string tmp = file + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "wb");
+    if (fp == NULL) return;
+
+    int head[CheckpointHead] = {inst.numRows, inst.numColumns, CS.K, (int)sizeof(CovT),
+                                (int)inst.Order, opt.maxIteration, lbUpper, iter, lastLns};
+    fwrite(CheckpointMagic, 1, sizeof(CheckpointMagic), fp);
+    fwrite(head, sizeof(int), CheckpointHead, fp);
+    fwrite(&hash, sizeof(hash), 1, fp);
+
+    std::string st = rnd.state();
+    put_array(fp, vector<char>(st.begin(), st.end()));
+
+    fwrite(&CS.totalWeight, sizeof(int), 1, fp);
+    fwrite(&CS.num_Cover, sizeof(int), 1, fp);
+    put_array(fp, CS.CS);
+    put_array(fp, CS.Col);
+    put_array(fp, CS.COVERED);
+    put_array(fp, CS.COST);
+    put_array(fp, CS.Cand);
+    put_array(fp, CSbest.CS);
+    put_array(fp, Freq);
+
+    bool ok = (fflush(fp) == 0);
+    fclose(fp);
+    if (ok) rename(tmp.c_str(), file.c_str());
+  }
+
+  // file から状態を読み，次の反復を返す（読めない・中身が壊れている・インスタンスや設定が違えば 0）
+  // lastLns には前に LNS を行った反復を入れる
+  int load_checkpoint(const std::string& file, const SolverOptions& opt, Rand& rnd, int& lastLns)
+  {
+    FILE* fp = fopen(file.c_str(), "rb");
+    if (fp == NULL) return 0;
+
+    char magic[sizeof(CheckpointMagic)];
+    int head[CheckpointHead];
+    std::uint64_t hash;
+    vector<char> st;
+    int tw, nc;
+    vector<int> best;
+    bool ok = fread(magic, 1, sizeof(magic), fp) == sizeof(magic)
+      && memcmp(magic, CheckpointMagic, sizeof(magic)) == 0
+      && fread(head, sizeof(int), CheckpointHead, fp) == (size_t)CheckpointHead
+      && head[0] == inst.numRows && head[1] == inst.numColumns
+      && head[2] == CS.K && head[3] == (int)sizeof(CovT)
+      && head[4] == (int)inst.Order && head[5] == opt.maxIteration && head[7] > 0
+      && fread(&hash, sizeof(hash), 1, fp) == 1 && hash == inst.fingerprint()
+      && get_array(fp, st)
+      && fread(&tw, sizeof(int), 1, fp) == 1
+      && fread(&nc, sizeof(int), 1, fp) == 1
+      && get_array(fp, CS.CS)
+      && get_array(fp, CS.Col)
+      && get_array(fp, CS.COVERED)
+      && get_array(fp, CS.COST)
+      && get_array(fp, CS.Cand)
+      && get_array(fp, best)
+      && get_array(fp, Freq);
+    fclose(fp);
+
+    ok = ok && (int)CS.Col.size() == inst.numColumns && (int)Freq.size() == inst.numColumns
+      && (int)CS.COVERED.size() == inst.numRows && (int)CS.COST.size() == inst.numRows;
+
+    // 列の番号が範囲内で重複せず，CS と Cand が SOLUTION と合っているか
+    ok = ok && distinct_columns(CS.CS, inst.numColumns) && distinct_columns(CS.Cand, inst.numColumns)
+      && distinct_columns(best, inst.numColumns)
+      && CS.CS.size() + CS.Cand.size() == (size_t)inst.numColumns;
+    for (size_t p = 0; ok && p < CS.CS.size(); p++) ok = CS.SOLUTION(CS.CS[p]) == 1;
+    for (size_t p = 0; ok && p < CS.Cand.size(); p++) ok = CS.SOLUTION(CS.Cand[p]) == 0;
+    if (!ok)
+    {
+      CS.initialize(inst);
+      Freq.assign(inst.numColumns, 0);
+      return 0;
+    }
+
+    CS.totalWeight = tw;
+    CS.num_Cover = nc;
+
+    // Cand は BMS で選ぶ順序に関わるので保存した順のまま使う
+    CS.CandPos.assign(inst.numColumns, -1);
+    for (size_t p = 0; p < CS.Cand.size(); p++) CS.CandPos[CS.Cand[p]] = p;
+
+    rnd.set_state(std::string(st.begin(), st.end()));
+
+    // CSbest は列だけ保存してあるので追加し直す
+    CSbest.initialize(inst);
+    for (int c : best) CSbest.add_column(inst, c);
+
+    lbUpper = head[6];
+    lastLns = head[8];
+    return head[7];
+  }
+
+  // CS を貪欲法で実行可能にする
+  // prune なら冗長な列を取り除く（Kを下げた warm start など）
+  void complete(bool prune, const SolverOptions& opt, Rand& rnd)
+  {
+    greedy_construction(inst, CS, ws, rnd, opt.graspAlpha);
+    if (prune) prune_redundant(inst, CS);
+  }
+
+  // 実行可能な CS から探索する
+  // opt.lbIteration > 0 なら初期解の重みを上界として下界を求め，
+  // 最良解が下界に達したら（最適と分かったら）探索をやめる
+  // first_iter > 1 ならチェックポイントから読んだ CS, CSbest のまま反復 first_iter から続ける
+  // （first_lns は保存した前の LNS の反復．下界は保存した上界で作り直すので同じになるが，
+  //   コアは途中で更新した分が失われるので，コアを使うときは中断しなかった場合と同じにはならない）
+  int search(int first_iter, const SolverOptions& opt, Rand& rnd,
+             vector<int>& best, SolverStats& stats, int first_lns = 0)
+  {
+    // 下界．コアを使うときも乗数が要るので求める
+    std::unique_ptr<SCPlagrangian> lag;
+    std::unique_ptr<SCPcore> core;
+
+    // 上界は初期解の重み（チェックポイントから続けるときは保存した値なので，同じ下界になる）
+    if (first_iter <= 1) lbUpper = CS.totalWeight;
+    stats.lowerBound = 0;
+    if (opt.lbIteration > 0 || opt.coreRow > 0)
+    {
+      lag.reset(new SCPlagrangian(inst, CS.K));
+      lag->compute(lbUpper, max(opt.lbIteration, 100));
+      stats.lowerBound = lag->integer_bound();
+    }
+    if (opt.coreRow > 0)
+      core.reset(new SCPcore(inst, *lag, opt.coreRow));
+
+    DLLcontrol ctl(opt.maxIteration);
+    ctl.target = max(stats.lowerBound, opt.targetWeight);
+    ctl.lag = lag.get();
+    ctl.core = core.get();
+    ctl.refresh = opt.coreRefresh;
+    ctl.first_iter = first_iter;
+    ctl.first_lns = first_lns;
+    ctl.part_target = part_target;
+    ctl.part_id = part_id;
+    ctl.bms = opt.bmsSample;
+    if (opt.scoreThreads > 1)
+    {
+      if (!team || team->size() != opt.scoreThreads) team.reset(new SCPteam(opt.scoreThreads));
+      ctl.team = team.get();
+      ctl.parallel_work = opt.parallelWork;
+      ctl.parallel_rows = opt.parallelRows;
+    }
+    if (opt.lnsEvery > 0)
+    {
+      if (!lns) lns.reset(new SCPlns(inst, opt.lnsFree));
+      lns->reserve(inst);
+      ctl.lns = lns.get();
+      ctl.lns_every = opt.lnsEvery;
+      ctl.lns_tries = opt.lnsTries;
+    }
+    std::uint64_t hash = opt.checkpointFile.empty() ? 0 : inst.fingerprint();
+    if (!opt.checkpointFile.empty() && opt.checkpointEvery > 0)
+    {
+      ctl.checkpoint_every = opt.checkpointEvery;
+      ctl.checkpoint = [&](int iter, int last_lns) {
+        save_checkpoint(opt.checkpointFile, iter, last_lns, hash, opt, rnd);
+      };
+    }
+
+    stats.iterations = run_dll(ctl, rnd);
+
+    // 目標の重みに達したか（達したら DLL_com はすぐ戻るので，ここまでの時間が到達時間）
+    stats.targetReached = opt.targetWeight > 0 && CSbest.totalWeight <= opt.targetWeight;
+    stats.targetIteration = stats.targetReached ? stats.iterations : 0;
+    stats.targetSeconds = stats.targetReached
+      ? std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() : 0;
+
+    // 終わった状態も書いておく（読み込むとすぐ終わるので，前の LNS の反復は使われない）
+    if (!opt.checkpointFile.empty())
+      save_checkpoint(opt.checkpointFile, stats.iterations + 1, stats.iterations, hash, opt, rnd);
+    stats.coreSize = core ? core->Columns.size() : inst.numColumns;
+
+    best = CSbest.CS;
+    sort(best.begin(), best.end());
+    return CSbest.totalWeight;
+  }
+
+  // K とコストの種類で特殊化した DLL_com を選んで実行する
+  // K = 1, 2 は定数にし，全ての列のコストが 1 なら割り算を省く
+  int run_dll(const DLLcontrol& ctl, Rand& rnd)
+  {
+    bool unit = true;
+    for (int j = 0; j < inst.numColumns && unit; j++) unit = (CS.Weight(j) == 1);
+
+    if (CS.K == 1)
+      return unit ? dll<SCPspec<1, true> >(ctl, rnd) : dll<SCPspec<1, false> >(ctl, rnd);
+    if (CS.K == 2)
+      return unit ? dll<SCPspec<2, true> >(ctl, rnd) : dll<SCPspec<2, false> >(ctl, rnd);
+    return unit ? dll<SCPspec<0, true> >(ctl, rnd) : dll<SCPgeneric>(ctl, rnd);
+  }
+
+  template <typename Spec>
+  int dll(const DLLcontrol& ctl, Rand& rnd)
+  {
+    return DLL_com<CovT, Spec>(inst, CS, CSbest, Freq, ctl, ws, rnd);
+  }
+
+  void load(const vector<int>& cols)
+  {
+    CS.initialize(inst);
+    for (int c : cols)
+    {
+      if (c >= 0 && c < inst.numColumns && !CS.SOLUTION(c) && inst.ColEntries[c].size() > 0)
+        CS.add_column(inst, c);
+    }
+  }
+
+  const vector<int>& columns() { return CS.CS; }
+
+  void add_row(int r)
+  {
+    CS.add_row(inst, r);
+  }
+
+  void remove_column(int c)
+  {
+    if (CS.SOLUTION(c))
+    {
+      CS.remove_column(inst, c);
+      remove_update_score(inst, CS, c);
+    }
+    CS.SCORE(c) = 0;
+    CS.SKCC(c) = 0;
+  }
+
+  void set_weight(int c, int w)
+  {
+    CS.set_weight(c, w);
+  }
+};
+
+
+// 連結成分の部分インスタンスとそのソルバ
+struct Solver::Part
+{
+  SCPinstance inst;
+  vector<int> cols;             // cols[j]: 成分の列jの元の番号
+  long nnz;
+  Solver solver;
+
+  Part(SCPinstance& parent, const SCPcomponent& comp, const vector<int>& colIndex, int k)
+    : inst(parent, comp.rows, comp.cols, colIndex), cols(comp.cols), nnz(comp.nnz),
+      solver(inst, k)
+  {
+  }
+};
+
+
+// 小さい成分でも最低限行う反復回数
+static const int PartMinIteration = 100;
+
+
+// コンストラクタ
+// COVERED の型はインスタンスの最大行次数で選ぶ
+Solver::Solver(SCPinstance &pData, int k_, const SolverOptions &opt_)
+  : inst(pData), k(k_), opt(opt_), width(cover_width(pData)), bestWeight(0),
+    partsReady(false)
+{
+  make_engine();
+}
+
+
+// width に合わせて engine を作る
+void Solver::make_engine()
+{
+  switch (width)
+  {
+  case COVER_U8:
+    engine.reset(new EngineT<std::uint8_t>(inst, k));
+    break;
+  case COVER_U16:
+    engine.reset(new EngineT<std::uint16_t>(inst, k));
+    break;
+  default:
+    engine.reset(new EngineT<int>(inst, k));
+    break;
+  }
+}
+
+
+// デストラクタ
+Solver::~Solver()
+{
+}
+
+
+// どの行も K列以上にカバーされうるか確認する
+// 確認しないと貪欲法が終わらない
+void Solver::check_instance()
+{
+  for (int i = 0; i < inst.numRows; i++)
+    if (inst.RowCovers[i].size() < k) throw DataException();
+}
+
+
+// 貪欲法の解から解く
+int Solver::solve()
+{
+  check_instance();
+  if (opt.componentThreads > 0 && opt.checkpointFile.empty() && decompose())
+    return solve_parts(NULL);
+
+  bestWeight = engine->run(NULL, opt, rnd, bestCols, stat);
+  return bestWeight;
+}
+
+
+// 列の集合 warm から解く
+int Solver::solve(const vector<int> &warm)
+{
+  check_instance();
+  if (opt.componentThreads > 0 && opt.checkpointFile.empty() && decompose())
+    return solve_parts(&warm);
+
+  bestWeight = engine->run(&warm, opt, rnd, bestCols, stat);
+  return bestWeight;
+}
+
+
+// 連結成分を求めて parts を作る
+// インスタンスを変更するまでは作り直さない（成分のソルバも試行の間で使い回す）
+bool Solver::decompose()
+{
+  if (!partsReady)
+  {
+    parts.clear();
+    vector<SCPcomponent> comps = find_components(inst, partIndex);
+    partOf.assign(inst.numColumns, -1);
+
+    if (comps.size() > 1)
+    {
+      for (size_t p = 0; p < comps.size(); p++)
+      {
+        for (int c : comps[p].cols) partOf[c] = p;
+        parts.emplace_back(new Part(inst, comps[p], partIndex, k));
+      }
+    }
+    partsReady = true;
+  }
+  return !parts.empty();
+}
+
+
+// 成分ごとに解いて解を合わせる
+// 反復回数は maxIteration を非ゼロ要素の数に比例して分ける（PartMinIteration 回は行う）
+// 成分は大きい順に opt.componentThreads 個のスレッドで取り出して解く．
+// 成分の乱数の種は rnd から成分の順に取るので，スレッドの数によらず同じ結果になる
+// （opt.targetWeight があれば最良解の重みの和が達したときに全ての成分を止めるので，
+//   スレッドが2つ以上だと止まる反復は成分の進み方で変わる）
+int Solver::solve_parts(const vector<int>* warm)
+{
+  long total = 0;
+  for (auto& part : parts) total += part->nnz;
+
+  vector<vector<int> > warms(parts.size());
+  if (warm != NULL)
+  {
+    for (int c : *warm)
+      if (c >= 0 && c < inst.numColumns && partOf[c] >= 0) warms[partOf[c]].push_back(partIndex[c]);
+  }
+
+  for (auto& part : parts)
+  {
+    SolverOptions& o = part->solver.options();
+    o = opt;
+    o.componentThreads = 0;
+    o.targetWeight = 0;                 // 目標は全体の重みなので part_target で止める
+    o.maxIteration = max((long)min(opt.maxIteration, PartMinIteration),
+                         (long)opt.maxIteration * part->nnz / max(total, 1L));
+    if (opt.componentThreads > 1) o.scoreThreads = 1;
+    part->solver.seed(rnd());
+  }
+
+  // 目標があれば，先に全ての成分の初期解を作って重みを報告しておき，
+  // 成分の最良解の重みの和が目標に達したところで全ての成分を止める
+  std::unique_ptr<PartTarget> target;
+  if (opt.targetWeight > 0)
+  {
+    target.reset(new PartTarget(opt.targetWeight, parts.size()));
+    for (size_t p = 0; p < parts.size(); p++)
+    {
+      Solver& s = parts[p]->solver;
+      s.engine->part_target = target.get();
+      s.engine->part_id = p;
+      target->report(p, s.engine->construct(warm == NULL ? NULL : &warms[p], s.opt, s.rnd));
+    }
+  }
+
+  vector<int> order(parts.size());
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(),
+              [&](int a, int b) { return parts[a]->nnz > parts[b]->nnz; });
+
+  std::atomic<int> next(0);
+  int n = order.size();
+  auto worker = [&]() {
+    for (int t = next++; t < n; t = next++)
+    {
+      int p = order[t];
+      Solver& s = parts[p]->solver;
+      if (target) s.bestWeight = s.engine->run_constructed(s.opt, s.rnd, s.bestCols, s.stat);
+      else if (warm == NULL) s.solve();
+      else s.solve(warms[p]);
+    }
+  };
+
+  vector<std::thread> threads;
+  for (int t = 1; t < min(opt.componentThreads, n); t++) threads.push_back(std::thread(worker));
+  worker();
+  for (std::thread& th : threads) th.join();
+
+  // 解を合わせる．下界と反復回数などは成分の和
+  bestWeight = 0;
+  bestCols.clear();
+  stat = SolverStats();
+  for (auto& part : parts)
+  {
+    for (int c : part->solver.best_columns()) bestCols.push_back(part->cols[c]);
+    bestWeight += part->solver.best_weight();
+    stat.lowerBound += part->solver.stats().lowerBound;
+    stat.iterations += part->solver.stats().iterations;
+    stat.coreSize += part->solver.stats().coreSize;
+  }
+  sort(bestCols.begin(), bestCols.end());
+
+  // 達したら全ての成分がその時点で止まるので，反復回数の和が到達までの反復
+  if (target)
+  {
+    for (auto& part : parts) part->solver.engine->part_target = NULL;
+    stat.targetReached = target->reached;
+    if (stat.targetReached)
+    {
+      stat.targetIteration = stat.iterations;
+      stat.targetSeconds = target->seconds;
+    }
+  }
+
+  // resume はこの解から続ける
+  engine->load(bestCols);
+
+  return bestWeight;
+}
+
+
+// 探索中の解から探索を続ける
+int Solver::resume()
+{
+  check_instance();
+  bestWeight = engine->resume(opt, rnd, bestCols, stat);
+  return bestWeight;
+}
+
+
+// チェックポイント file から探索を続ける
+int Solver::resume_checkpoint(const std::string &file)
+{
+  check_instance();
+  bestWeight = engine->restart(file, opt, rnd, bestCols, stat);
+  return bestWeight;
+}
+
+
+// 行を追加する
+// 行の次数が COVERED の型に収まらなくなったら engine を作り直して解を移す
+int Solver::add_row(const vector<int> &cols)
+{
+  int r = inst.add_row(cols);
+  partsReady = false;
+
+  if (cover_width(inst) != width)
+  {
+    vector<int> cs = engine->columns();
+    width = cover_width(inst);
+    make_engine();
+    engine->load(cs);
+  }
+  else
+    engine->add_row(r);
+
+  return r;
+}
+
+
+// 列cを削除する
+void Solver::remove_column(int c)
+{
+  engine->remove_column(c);
+  inst.remove_column(c);
+  partsReady = false;
+}
+
+
+// 列cのコストを w にする
+void Solver::set_weight(int c, int w)
+{
+  engine->set_weight(c, w);
+  inst.set_weight(c, w);
+  partsReady = false;
+}
+
+
+
+// 解をファイルに書く
+// 1行目に重みと列数，2行目にファイル上の列番号（1から）を昇順に書く
+bool write_solution(const std::string &file, SCPinstance &inst, int K,
+                    const vector<int> &cols, int totalWeight)
+{
+  FILE* fp = fopen(file.c_str(), "w");
+  if (fp == NULL) return false;
+
+  vector<int> orig;
+  for (int c : cols) orig.push_back(inst.OrigCol[c] + 1);
+  sort(orig.begin(), orig.end());
+
+  fprintf(fp, "%d %d %d\n", totalWeight, (int)orig.size(), K);
+  for (size_t i = 0; i < orig.size(); i++)
+    fprintf(fp, i + 1 < orig.size() ? "%d " : "%d\n", orig[i]);
+  if (orig.empty()) fprintf(fp, "\n");
+
+  return fclose(fp) == 0;
+}
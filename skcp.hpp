@@ -0,0 +1,154 @@
+//---------------------------------------------------------------------------
+// 集合Kカバー問題のソルバ（libskcp）
+// Solver はインスタンスとKを受け取り，DLL_com で解く．
+// 探索用の配列は Solver が持つので，何度 solve を呼んでも確保し直さない．
+// 列の番号は SCPinstance の内部の番号（ファイル上の番号は inst.OrigCol）
+//---------------------------------------------------------------------------
+#pragma once
+
+#include "SCPv.hpp"
+#include "Random.hpp"
+#include <vector>
+#include <string>
+#include <memory>
+
+//
+//  ソルバのパラメータ
+//
+struct SolverOptions
+{
+  int maxIteration;             // DLL_com の反復回数
+  int lbIteration;              // 下界を求める劣勾配法の反復回数（0 なら求めない）
+  int coreRow;                  // >0 なら追加する列を各行の被約費用の小さい K+coreRow 列に絞る
+  int coreRefresh;              // コアを広げる間隔（反復回数）
+  std::string checkpointFile;   // 空でなければ探索の状態をこのファイルに書く
+  int checkpointEvery;          // チェックポイントを書く間隔（反復回数．0 なら終わったときだけ）
+  int bmsSample;                // >0 なら追加・削除する列を bmsSample 個の無作為な候補から選ぶ（BMS）
+  double graspAlpha;            // <1 なら貪欲法でスコアが graspAlpha * 最大値 以上の列から無作為に選ぶ
+  int scoreThreads;             // >1 なら1回の探索の中でスコアの更新をこの数のスレッドで分ける
+  int parallelWork;             // 調べる要素（行の列リストの長さの和）がこれ以上の更新だけ分ける
+  int parallelRows;             // K回カバーされない行がこれ以上なら重みの更新も分ける
+  int componentThreads;         // >0 なら連結成分に分けて，この数のスレッドで成分ごとに解く
+  int lnsEvery;                 // >0 ならこの反復回数ごとに解の一部を外して分枝限定法で直す（LNS）
+  int lnsFree;                  // LNS で1回に外す解の列の数
+  int lnsTries;                 // 1回の LNS で壊して直す回数
+  int targetWeight;             // >0 なら最良解の重みがこれ以下になったところで探索をやめる
+
+  SolverOptions() : maxIteration(50000), lbIteration(0), coreRow(0), coreRefresh(1000),
+                    checkpointEvery(0), bmsSample(0), graspAlpha(1.0),
+                    scoreThreads(1), parallelWork(20000), parallelRows(64),
+                    componentThreads(0), lnsEvery(0), lnsFree(8), lnsTries(20),
+                    targetWeight(0) {}
+};
+
+
+//
+//  solve / resume の結果の情報
+//
+struct SolverStats
+{
+  int lowerBound;               // ラグランジュ緩和の下界（求めなければ 0）
+  int iterations;               // DLL_com で実際に行った反復回数
+  int coreSize;                 // 探索を終えたときのコアの列数（コアを使わなければ列数）
+  bool targetReached;           // 最良解が targetWeight に達したか
+  int targetIteration;          // 達した反復（初期解で達していれば 0）
+  double targetSeconds;         // 探索を始めてから達するまでの秒数
+
+  SolverStats() : lowerBound(0), iterations(0), coreSize(0),
+                  targetReached(false), targetIteration(0), targetSeconds(0) {}
+};
+
+
+//
+//
+//  Class Solver  集合Kカバー問題を解くクラス
+//
+//
+class Solver
+{
+public:
+  Solver(SCPinstance &pData, int k, const SolverOptions &opt = SolverOptions());
+  ~Solver();
+
+  // 乱数の種を設定
+  void seed(std::uint_fast32_t s) { rnd.seed(s); }
+
+  // 貪欲法の解から解いて，最良解の重みを返す
+  // options().componentThreads > 0 でインスタンスが連結成分に分かれていれば，
+  // 成分ごとに（反復回数を非ゼロ要素の数に比例させて）解いて解を合わせる
+  // （チェックポイントを使うときは分けない）．targetWeight があれば，成分の最良解の
+  // 重みの和が達したところで全ての成分を止める（到達の反復は成分の反復の和）
+  int solve();
+
+  // 列の集合 warm から解いて，最良解の重みを返す
+  // warm で K回カバーされない行があれば貪欲法で列を追加し，
+  // 冗長な列があれば（小さいKの warm start など）取り除いてから始める
+  int solve(const std::vector<int> &warm);
+
+  // インスタンスの変更：inst を変えて，探索中の解（COVERED, SCORE など）も更新する
+  // Solver があるインスタンスはこれらを通して変更する
+  int add_row(const std::vector<int> &cols);    // 行を追加し，その番号を返す
+  void remove_column(int c);                    // 列cを削除する
+  void set_weight(int c, int w);                // 列cのコストを w にする
+
+  // 変更後の探索中の解から（足りない行は貪欲法で補い，冗長な列は取り除いて）
+  // 探索を続け，最良解の重みを返す
+  // 行の重み COST は前回の探索のものを引き継ぐ
+  int resume();
+
+  // options().checkpointFile に書いたチェックポイント file を読み，中断した反復から
+  // 続けて最良解の重みを返す．乱数の状態も戻すので（コアを使わなければ）
+  // 中断しなかった場合と同じ結果になる（LNS の間隔・下界を求めた上界も保存したものを使う）
+  // 読めない・中身が壊れている・インスタンス（中身のハッシュ）・番号の付け替え方・K・
+  // maxIteration が書いたときと違うときは DataException
+  int resume_checkpoint(const std::string &file);
+
+  // 最良解（solve / resume の結果．インスタンスを変更しても自動では直さない）
+  int best_weight() const { return bestWeight; }
+  const std::vector<int>& best_columns() const { return bestCols; }
+  const SolverStats& stats() const { return stat; }
+
+  int K() const { return k; }
+  SolverOptions& options() { return opt; }
+
+  class Engine;                 // COVERED の型ごとの実装（skcp.cpp）
+  struct Part;                  // 連結成分の部分インスタンスとそのソルバ（skcp.cpp）
+
+private:
+  SCPinstance &inst;
+  int k;
+  SolverOptions opt;
+  CoverWidth width;             // engine の COVERED の型
+  Rand rnd;
+  std::unique_ptr<Engine> engine;
+
+  int bestWeight;               // 最良解の重み
+  std::vector<int> bestCols;    // 最良解の列（昇順）
+  SolverStats stat;
+
+  std::vector<std::unique_ptr<Part> > parts;    // 連結成分（分けないときは空）
+  std::vector<int> partOf;                      // partOf[j]: 列jの成分（行のない列は -1）
+  std::vector<int> partIndex;                   // partIndex[j]: 列jの成分の中での番号
+  bool partsReady;                              // parts が今のインスタンスのものか
+
+  // width に合わせて engine を作る
+  void make_engine();
+
+  // 連結成分を求めて parts を作る．2つ以上に分かれれば true
+  bool decompose();
+
+  // 成分ごとに解いて解を合わせ，最良解の重みを返す（warm は成分に分けて渡す）
+  int solve_parts(const std::vector<int>* warm);
+
+  // どの行も K列以上にカバーされうるか確認する（できなければ DataException）
+  void check_instance();
+};
+
+
+// 列の集合 cols が全ての行を K回カバーし，重みが totalWeight か確認する
+bool check_solution(SCPinstance &inst, int K, const std::vector<int> &cols, int totalWeight);
+
+
+// 解をファイルに書く（列番号はファイル上の番号）．書けなければ false
+bool write_solution(const std::string &file, SCPinstance &inst, int K,
+                    const std::vector<int> &cols, int totalWeight);
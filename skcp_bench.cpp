@@ -0,0 +1,385 @@
+//---------------------------------------------------------------------------
+// DLL_com の部品のマイクロベンチマーク
+//
+//   ./skcp_bench [-K k] [-time sec] [-filter name] [-synthetic rows,cols,density] [files...]
+//
+// インスタンスごとに貪欲法の解を作り，その状態で各部品を繰り返し呼んで
+// 1回あたりの時間 (ns/op) と，触れた要素 1個あたりの時間 (ns/elem) を出す．
+// 要素は部品ごとに次のもの
+//   add_column, remove_column            列の非ゼロ要素 |C_j|
+//   add_update_score, remove_update_score  |C_j| + C_j の行を含む列の数の和
+//   add_column_update, remove_column_update  同上（列の追加・削除も含む）
+//   update_SKCC                           近傍の列の数
+//   get_add_rule                          調べた列の数（列数）
+//   get_remove_rule                       解の列の数
+// 準備（状態を戻すための列の追加・削除など）は時間に含めない．
+// スコアの更新を計った後は，スコアを計算し直してから次の部品を計る．
+// ファイルを指定しなければ，付属のインスタンスと合成インスタンスを使う．
+//---------------------------------------------------------------------------
+#include "SCPv.hpp"
+#include "SCPkernel.hpp"
+#include "SCPgenerate.hpp"
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+using namespace std;
+
+typedef std::chrono::steady_clock Clock;
+
+
+// 計測の結果：ops 回の操作に ns ナノ秒かかり，elems 個の要素に触れた
+struct Sample
+{
+  double ns;
+  long ops;
+  long elems;
+
+  Sample() : ns(0), ops(0), elems(0) {}
+};
+
+
+// ベンチマークの設定
+struct BenchConfig
+{
+  int K;
+  double minTime;               // 1つの部品を計測する時間（秒）
+  string filter;                // 空でなければ名前にこれを含む部品だけ
+
+  BenchConfig() : K(2), minTime(0.2) {}
+};
+
+
+// 開始からのナノ秒
+static double elapsed_ns(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+
+// body（1回分の計測を Sample で返す）を計測時間が minTime 秒になるまで繰り返し，
+// 結果を1行出力する
+template <typename F>
+void run_bench(const BenchConfig& conf, const string& instance, const string& name, F body)
+{
+  if (!conf.filter.empty() && name.find(conf.filter) == string::npos) return;
+
+  Sample total;
+  Clock::time_point start = Clock::now();
+  double limit = conf.minTime * 1e9;
+
+  // 準備の時間が長くても終わるように，経過時間でも打ち切る
+  while (total.ns < limit && elapsed_ns(start) < 20 * limit)
+  {
+    Sample s = body();
+    total.ns += s.ns;
+    total.ops += s.ops;
+    total.elems += s.elems;
+  }
+
+  printf("%-20s %-22s %10ld %10.1f %10.1f %8.3f\n",
+         instance.c_str(), name.c_str(), total.ops,
+         total.ops > 0 ? total.ns / total.ops : 0.0,
+         total.ops > 0 ? (double)total.elems / total.ops : 0.0,
+         total.elems > 0 ? total.ns / total.elems : 0.0);
+}
+
+
+// 時計を2回続けて読むのにかかる時間（ns）
+static double clock_overhead()
+{
+  double m = 1e9;
+  for (int i = 0; i < 1000; i++)
+  {
+    Clock::time_point t = Clock::now();
+    m = min(m, elapsed_ns(t));
+  }
+  return m;
+}
+
+
+// DLL_com を始めるときと同じスコアにする
+template <typename CovT>
+void reset_score(SCPinstance& inst, SCPsolution<CovT>& cs)
+{
+  for (int c = 0; c < inst.numColumns; c++) cs.SCORE(c) = compute_score(inst, cs, c);
+}
+
+
+// 列cのスコアの更新で調べる要素の数
+static long update_elems(SCPinstance& inst, int c)
+{
+  long n = inst.ColEntries[c].size();
+  for (int r : inst.ColEntries[c]) n += inst.RowCovers[r].size();
+  return n;
+}
+
+
+// 1つのインスタンスで全ての部品を計測する
+template <typename CovT>
+void bench_instance(SCPinstance& inst, const string& name, const BenchConfig& conf)
+{
+  Rand rnd;
+  rnd.seed(1);
+
+  SCPsolution<CovT> cs(inst, conf.K);
+  cs.initialize(inst);
+  SCPworkspace ws(inst);
+  greedy_construction(inst, cs, ws, rnd);
+  reset_score(inst, cs);
+
+  // 解に入っていない列（追加する候補）
+  vector<int> outside;
+  for (int c = 0; c < inst.numColumns; c++)
+    if (!cs.SOLUTION(c) && inst.ColEntries[c].size() > 0) outside.push_back(c);
+  random_permutation(outside, rnd);
+
+  const int Batch = 64;
+  size_t pos = 0;
+
+  // 解の外から Batch 列を順に取り出す
+  auto next_batch = [&](vector<int>& cols) {
+    cols.clear();
+    for (int i = 0; i < Batch && !outside.empty(); i++)
+    {
+      cols.push_back(outside[pos]);
+      pos = (pos + 1) % outside.size();
+    }
+  };
+
+  // 解の中から Batch 列を選ぶ
+  auto inside_batch = [&](vector<int>& cols) {
+    cols.clear();
+    for (int i = 0; i < Batch && i < (int)cs.CS.size(); i++)
+      cols.push_back(cs.CS[rnd(0, cs.CS.size() - 1)]);
+    sort(cols.begin(), cols.end());
+    cols.erase(unique(cols.begin(), cols.end()), cols.end());
+  };
+
+  vector<int> cols;
+
+  run_bench(conf, name, "add_column", [&]() {
+    Sample s;
+    next_batch(cols);
+    Clock::time_point t = Clock::now();
+    for (int c : cols) cs.add_column(inst, c);
+    s.ns = elapsed_ns(t);
+    for (int c : cols) { cs.remove_column(inst, c); s.elems += inst.ColEntries[c].size(); }
+    s.ops = cols.size();
+    return s;
+  });
+
+  run_bench(conf, name, "remove_column", [&]() {
+    Sample s;
+    inside_batch(cols);
+    Clock::time_point t = Clock::now();
+    for (int c : cols) cs.remove_column(inst, c);
+    s.ns = elapsed_ns(t);
+    for (int c : cols) { cs.add_column(inst, c); s.elems += inst.ColEntries[c].size(); }
+    s.ops = cols.size();
+    return s;
+  });
+
+  // スコアの更新は探索と同じく1列ずつ追加（削除）した直後に呼び，1回ずつ計る
+  // （時計を読む時間は clock_overhead() を引く）
+  double overhead = clock_overhead();
+
+  run_bench(conf, name, "add_update_score", [&]() {
+    Sample s;
+    next_batch(cols);
+    for (int c : cols)
+    {
+      cs.add_column(inst, c);
+      Clock::time_point t = Clock::now();
+      add_update_score(inst, cs, c);
+      s.ns += max(0.0, elapsed_ns(t) - overhead);
+      cs.remove_column(inst, c);
+      s.elems += update_elems(inst, c);
+    }
+    s.ops = cols.size();
+    return s;
+  });
+  reset_score(inst, cs);
+
+  run_bench(conf, name, "remove_update_score", [&]() {
+    Sample s;
+    inside_batch(cols);
+    for (int c : cols)
+    {
+      cs.remove_column(inst, c);
+      Clock::time_point t = Clock::now();
+      remove_update_score(inst, cs, c);
+      s.ns += max(0.0, elapsed_ns(t) - overhead);
+      cs.add_column(inst, c);
+      s.elems += update_elems(inst, c);
+    }
+    s.ops = cols.size();
+    return s;
+  });
+  reset_score(inst, cs);
+
+  // 追加・削除とスコアの更新を1回の走査で行う部品
+  run_bench(conf, name, "add_column_update", [&]() {
+    Sample s;
+    next_batch(cols);
+    for (int c : cols)
+    {
+      Clock::time_point t = Clock::now();
+      add_column_update(inst, cs, c);
+      s.ns += max(0.0, elapsed_ns(t) - overhead);
+      remove_column_update(inst, cs, c);
+      s.elems += update_elems(inst, c);
+    }
+    s.ops = cols.size();
+    return s;
+  });
+
+  run_bench(conf, name, "remove_column_update", [&]() {
+    Sample s;
+    inside_batch(cols);
+    for (int c : cols)
+    {
+      Clock::time_point t = Clock::now();
+      remove_column_update(inst, cs, c);
+      s.ns += max(0.0, elapsed_ns(t) - overhead);
+      add_column_update(inst, cs, c);
+      s.elems += update_elems(inst, c);
+    }
+    s.ops = cols.size();
+    return s;
+  });
+
+  run_bench(conf, name, "update_SKCC", [&]() {
+    Sample s;
+    next_batch(cols);
+    Clock::time_point t = Clock::now();
+    for (int c : cols) update_SKCC(inst, cs, c);
+    s.ns = elapsed_ns(t);
+    for (int c : cols) s.elems += inst.Neighborhood[c].size();
+    s.ops = cols.size();
+    return s;
+  });
+
+  run_bench(conf, name, "get_remove_rule", [&]() {
+    Sample s;
+    Clock::time_point t = Clock::now();
+    for (int i = 0; i < Batch; i++) get_remove_rule(inst, cs, i, ws, rnd);
+    s.ns = elapsed_ns(t);
+    s.ops = Batch;
+    s.elems = (long)Batch * cs.CS.size();
+    return s;
+  });
+
+  // 列を1つ取り除いて実行可能でない状態にして，追加する列を選ぶ
+  if (!cs.CS.empty())
+  {
+    int c0 = cs.CS[0];
+    cs.remove_column(inst, c0);
+    remove_update_score(inst, cs, c0);
+    for (int c = 0; c < inst.numColumns; c++) cs.SKCC(c) = 1;
+
+    run_bench(conf, name, "get_add_rule", [&]() {
+      Sample s;
+      Clock::time_point t = Clock::now();
+      for (int i = 0; i < Batch; i++) get_add_rule(inst, cs, (const vector<int>*)NULL, ws, rnd);
+      s.ns = elapsed_ns(t);
+      s.ops = Batch;
+      s.elems = (long)Batch * inst.numColumns;
+      return s;
+    });
+
+    cs.add_column(inst, c0);
+    reset_score(inst, cs);
+  }
+}
+
+
+// インスタンスを読み込み，COVERED の型に合わせて計測する
+static void bench_file(const string& file, const string& name, const BenchConfig& conf)
+{
+  try {
+    SCPinstance inst(file);
+    for (int i = 0; i < inst.numRows; i++)
+    {
+      if (inst.RowCovers[i].size() < conf.K)
+      {
+        cerr << name << ": some row has fewer than K columns" << endl;
+        return;
+      }
+    }
+
+    switch (cover_width(inst))
+    {
+    case COVER_U8:  bench_instance<std::uint8_t>(inst, name, conf); break;
+    case COVER_U16: bench_instance<std::uint16_t>(inst, name, conf); break;
+    default:        bench_instance<int>(inst, name, conf); break;
+    }
+  } catch (DataException&) {
+    cerr << "Failed to read " << file << endl;
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  BenchConfig conf;
+  vector<string> files;
+  vector<string> synthetic;
+
+  for (int a = 1; a < argc; a++)
+  {
+    string opt = argv[a];
+    if (opt == "-K" && a + 1 < argc) conf.K = atoi(argv[++a]);
+    else if (opt == "-time" && a + 1 < argc) conf.minTime = atof(argv[++a]);
+    else if (opt == "-filter" && a + 1 < argc) conf.filter = argv[++a];
+    else if (opt == "-synthetic" && a + 1 < argc) synthetic.push_back(argv[++a]);
+    else if (opt[0] == '-')
+    {
+      cerr << "Usage: ./skcp_bench [-K k] [-time sec] [-filter name]"
+           << " [-synthetic rows,cols,density] [files...]" << endl;
+      return -1;
+    }
+    else files.push_back(opt);
+  }
+
+  if (files.empty() && synthetic.empty())
+  {
+    files = {"scp41.txt", "scp45.txt", "scp51.txt", "scpa1.txt",
+             "scpb1.txt", "scpc1.txt", "scpnrg1.txt"};
+    synthetic = {"1000,10000,0.01", "1000,10000,0.05"};
+  }
+
+  printf("%-20s %-22s %10s %10s %10s %8s\n",
+         "instance", "benchmark", "ops", "ns/op", "elem/op", "ns/elem");
+
+  for (const string& f : files) bench_file(f, f, conf);
+
+  for (const string& spec : synthetic)
+  {
+    int rows = 0, cols = 0;
+    double density = 0;
+    if (sscanf(spec.c_str(), "%d,%d,%lf", &rows, &cols, &density) != 3
+        || rows <= 0 || cols <= 0 || density <= 0)
+    {
+      cerr << "Bad -synthetic " << spec << endl;
+      continue;
+    }
+
+    GeneratorOptions gen;
+    gen.rows = rows;
+    gen.cols = cols;
+    gen.density = density;
+    gen.K = conf.K;
+    gen.seed = 12345;
+
+    string file = "skcp_bench_synthetic.tmp";
+    if (generate_instance(file, gen))
+      bench_file(file, "syn:" + spec, conf);
+    remove(file.c_str());
+  }
+
+  return 0;
+}
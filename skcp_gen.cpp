@@ -0,0 +1,60 @@
+//---------------------------------------------------------------------------
+// 合成インスタンスを作るツール
+//
+//   ./skcp_gen file [-rows n] [-cols n] [-density d] [-degree uniform|powerlaw]
+//                   [-alpha a] [-cost unicost|uniform|degree] [-cost_max m]
+//                   [-K k] [-seed s]
+//---------------------------------------------------------------------------
+#include "SCPgenerate.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+using namespace std;
+
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    cout << "Usage: ./skcp_gen file [-rows n] [-cols n] [-density d]"
+         << " [-degree uniform|powerlaw] [-alpha a]"
+         << " [-cost unicost|uniform|degree] [-cost_max m] [-K k] [-seed s]" << endl;
+    return 0;
+  }
+
+  string file = argv[1];
+  GeneratorOptions gen;
+
+  for (int a = 2; a + 1 < argc; a += 2)
+  {
+    string opt = argv[a];
+    string val = argv[a + 1];
+
+    if (opt == "-rows") gen.rows = atoi(val.c_str());
+    else if (opt == "-cols") gen.cols = atoi(val.c_str());
+    else if (opt == "-density") gen.density = atof(val.c_str());
+    else if (opt == "-degree") gen.degree = (val == "powerlaw") ? DEGREE_POWERLAW : DEGREE_UNIFORM;
+    else if (opt == "-alpha") gen.alpha = atof(val.c_str());
+    else if (opt == "-cost")
+    {
+      if (val == "unicost") gen.cost = COST_UNICOST;
+      else if (val == "degree") gen.cost = COST_DEGREE;
+      else gen.cost = COST_UNIFORM;
+    }
+    else if (opt == "-cost_max") gen.costMax = atoi(val.c_str());
+    else if (opt == "-K") gen.K = atoi(val.c_str());
+    else if (opt == "-seed") gen.seed = strtoul(val.c_str(), NULL, 10);
+    else
+    {
+      cerr << "Unknown option: " << opt << endl;
+      return -1;
+    }
+  }
+
+  if (!generate_instance(file, gen))
+  {
+    cerr << "Failed to write " << file << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -1,498 +1,204 @@
-#include "SCPv.hpp"
-#include "Random.hpp"
+#include "skcp.hpp"
+#include "SCPjobs.hpp"
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <cstdio>
-#include <cassert>
 #include <vector>
-#include <algorithm>
-#include <random>
 #include <limits>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <sys/stat.h>
 using namespace std;
 
 
-vector<int> SKCC;
-vector<int> COST;
-vector<int> SCORE;
-vector<int> TIMES;
-
-
-int compute_score(SCPinstance& inst,
-                  SCPsolution& cs,
-                  int c)
-{
-  int sc = 0;
-  for (int r : inst.ColEntries[c]) {
-    if (cs.SOLUTION[c] && (cs.COVERED[r] == cs.K)) sc -= COST[r];
-    else if (!cs.SOLUTION[c] && cs.COVERED[r] < cs.K) sc += COST[r];
-  }
-  return sc;
-}
-
-
-// csに含まれない列から最大スコアのものを選んで返す
-int get_column_maxscore(SCPinstance &inst,
-                        SCPsolution& cs,
-                        vector<int>& score,
-                        Rand& rnd)
+// チェックポイントと解を書くファイル
+struct RunFiles
 {
-  std::vector<int> maxCols;
-  double maxScore = 0.0;
-  int maxc = 0;
-  double scw = 0.0;
+  string checkpoint;            // 空でなければ 行・試行ごとに探索の状態を書き，あれば続きから解く
+  string solution;              // 空でなければ 行ごとに試行の中の最良解を書く
 
-  for (int c = 0; c < inst.numColumns; c++)
+  string checkpoint_file(int line, int trial) const
   {
-    if (cs.SOLUTION[c]) { continue; }
-
-    scw = (double)score[c]/(double)inst.Weight[c];
-    // 最大スコアの列をチェック
-    if (maxScore < scw)
-    {
-      maxScore = scw;
-      maxCols.clear();
-      maxCols.push_back(c);
-    }
-    else if (maxScore == scw)
-      maxCols.push_back(c);
-  } // End for c
+    if (checkpoint.empty()) return "";
+    return checkpoint + "_" + to_string(line) + "_" + to_string(trial) + ".ckp";
+  }
 
-  if (maxCols.size() == 1) maxc = maxCols[0];
-  else
+  string solution_file(int line) const
   {
-    int j = rnd(0, maxCols.size() - 1);
-    maxc = maxCols[j];
+    return solution + "_" + to_string(line) + ".sol";
   }
-
-  return maxc;
-}
+};
 
 
-int get_add_rule(SCPinstance &inst,
-		 SCPsolution& cs,
-		 Rand& rnd)
+// インスタンスのファイル名からパスと拡張子を除いた名前（minvals.txt の instance 列）
+string instance_name(const string& file)
 {
-  std::vector<int> maxCols;
-  double maxScore = 0.0;
-  int retc = 0;
-  double scw = 0.0;
-  int oldest_time = numeric_limits<int>::max();
-
-  for (int c = 0; c < inst.numColumns; c++)
-  {
-    if (cs.SOLUTION[c] == 1) { continue; }
-    if (SKCC[c] == 0) { continue; }
-
-
-    scw = (double)SCORE[c]/(double)inst.Weight[c];
-    // 最大スコアの列をチェック
-    if (maxScore < scw)
-    {
-      maxScore = scw;
-      maxCols.clear();
-      maxCols.push_back(c);
-    }
-    else if (maxScore == scw)
-      maxCols.push_back(c);
-  } // End for c
-
-  if (maxCols.size() == 1) retc = maxCols[0];
-  else
-  {
-    for (int c : maxCols) {
-      if (TIMES[c] < oldest_time) {
-        oldest_time = TIMES[c];
-        retc = c;
-      }
-    }
-  }
-
-  return retc;
-} // add_rule
+  size_t b = file.find_last_of('/');
+  b = (b == string::npos) ? 0 : b + 1;
+  size_t e = file.find_last_of('.');
+  if (e == string::npos || e < b) e = file.size();
+  return file.substr(b, e - b);
+}
 
 
-// REMOVE-RULE
-int get_remove_rule(SCPinstance &inst,
-		    SCPsolution& cs,
-                    int iter,
-		    Rand& rnd)
+// 目標の重みのファイル（minvals.txt の形式）を読む
+// 1行目は見出し，以降の各行は instance,K,重み,K,重み,... で，(instance, K) -> 重み にする
+bool load_targets(const string& file, map<pair<string, int>, int>& targets)
 {
-  std::vector<int> maxCols;
-  double maxScore = numeric_limits<int>::min();
-  int retc = 0;
-  double scw = 0.0;
+  ifstream in(file);
+  if (in.fail()) return false;
 
-  int oldest_time = numeric_limits<int>::max();
-
-  if (rnd() % 100 < 95)
+  string line;
+  getline(in, line);
+  while (getline(in, line))
   {
-    for (int c : cs.CS) {
-      if (TIMES[c] > 0 && TIMES[c] == iter - 1) continue;
-
-      // Araki
-      // スコアが0の列の取り扱い
-      // すべての行をk回カバーしている場合のみ取り除く
-      bool flg = false;
-      if (SCORE[c] == 0) {
-        for (int r : inst.ColEntries[c]) {
-          if (cs.COVERED[r] < cs.K) {
-            flg = true;
-            break;
-          }
-        }
-        if (flg) continue;
-      }
-
-      scw = (double)SCORE[c]/(double)inst.Weight[c];
-
-      // 最大スコアの列をチェック
-      if (maxScore < scw)  {
-        maxScore = scw;
-        maxCols.clear();
-        maxCols.push_back(c);
-      }
-      else if (maxScore == scw)
-        maxCols.push_back(c);
-    } // End for c
-
-    if (maxCols.size() == 1) retc = maxCols[0];
-    else
+    stringstream ss(line);
+    string name, k, w;
+    getline(ss, name, ',');
+    while (getline(ss, k, ',') && getline(ss, w, ','))
     {
-      for (int c : maxCols) {
-        if (TIMES[c] < oldest_time) {
-          oldest_time = TIMES[c];
-          retc = c;
-        }
-      }
+      if (!k.empty() && !w.empty()) targets[make_pair(name, atoi(k.c_str()))] = atoi(w.c_str());
     }
   }
-  else
-  {
-    // 5%
-    int maxw = 0;
-    for (int c : cs.CS) {
-      if (TIMES[c] < oldest_time) {
-        oldest_time = TIMES[c];
-        maxw = inst.Weight[c];
-        retc = c;
-      }
-      else if (TIMES[c] == oldest_time) {
-        if (maxw < inst.Weight[c]) {
-          maxw = inst.Weight[c];
-          retc = c;
-        }
-      }
-    }
-  }
-  return retc;
-}
-
-
-// 配列の順序をランダムに入れ替える
-void random_permutation(vector<int>& A, Rand& rnd)
-{
-  int j;
-  int n = A.size();
-  for (int i = 0; i < n-1; ++i)
-  {
-    j = rnd(i, n-1);
-    swap(A[i], A[j]);
-  }
+  return true;
 }
 
 
-void add_update_score(SCPinstance& inst, SCPsolution& cs, int c)
+// 1回の試行．チェックポイントがあればそこから続け，なければ warm（NULL なら貪欲法）から解く
+void solve_trial(Solver& solver, const string& ckpt, const vector<int>* warm)
 {
-  SCORE[c] = 0;
-  for (int r : inst.ColEntries[c])
-  {
-    if (cs.COVERED[r] == cs.K) SCORE[c] -= COST[r];
-  }
+  solver.options().checkpointFile = ckpt;
 
-  for (int r : inst.ColEntries[c])
+  if (!ckpt.empty() && ifstream(ckpt).good())
   {
-    if (cs.COVERED[r] == cs.K)
-    {
-      for (int rc : inst.RowCovers[r]) {
-        if (rc != c) SCORE[rc] -= COST[r];
-      }
+    try {
+      solver.resume_checkpoint(ckpt);
+      return;
+    } catch (DataException&) {
+      cerr << "Ignore checkpoint " << ckpt << endl;
     }
-    else if (cs.COVERED[r] == cs.K + 1)
-    {
-      for (int rc : inst.RowCovers[r])
-      {
-	if (cs.SOLUTION[rc] && rc != c) {
-	  SCORE[rc] += COST[r];
-	}
-      }
-    } // End if covered[r] == K+1
-  } // end for r
-}
-
-
-void remove_update_score(SCPinstance& inst, SCPsolution& cs, int c)
-{
-  SCORE[c] = 0;
-  for (int r : inst.ColEntries[c])
-  {
-    if (cs.COVERED[r] < cs.K) SCORE[c] += COST[r];
   }
 
-  for (int r : inst.ColEntries[c])
-  {
-    // r行がK回カバーされなくなったら，rを含む行のスコアを増加
-    if (cs.COVERED[r] == cs.K-1) {
-	for (int rc : inst.RowCovers[r])
-        {
-	  if (rc != c)
-          {
-            SCORE[rc] += COST[r];
-          }
-	} // End: for rc
-      }
-    else if (cs.COVERED[r] == cs.K)
-    {
-      for (int rc : inst.RowCovers[r])
-      {
-        if (cs.SOLUTION[rc] && rc != c)
-        {
-          SCORE[rc] -= COST[r];
-        }
-      }
-    }
-  } // end for r
-} // end remove_update_score
+  if (warm == NULL) solver.solve();
+  else solver.solve(*warm);
+}
 
 
-// 列colの近傍のSKCCを1にする
-void update_SKCC(SCPinstance& inst, SCPsolution& cs, int col)
+// 行 line の最良解を書く
+void save_best(SCPinstance& instance, int K, int line, const RunFiles& files,
+               const vector<int>& cols, int weight)
 {
-  for (int c : inst.Neighborhood[col]) {
-      SKCC[c] = 1;
-  }
-  // for (int r : inst.ColEntries[col]) {
-  //   if (cs.COVERED[r] < cs.K) {
-  //     for (int rc : inst.RowCovers[r]) {
-  //       if (rc != col) SKCC[rc] = 1;
-  //     }
-  //   }
-  // }
+  if (files.solution.empty() || cols.empty()) return;
+  if (!write_solution(files.solution_file(line), instance, K, cols, weight))
+    cerr << "Failed to write " << files.solution_file(line) << endl;
 }
 
 
-
-// 貪欲法：スコア最大の列をK列選ぶ
-// 引数の cs に結果が入る
-SCPsolution greedy_construction(SCPinstance &inst,
-                                int k,
-                                Rand &rnd)
+// 行ごとの結果．試行は別々のジョブとして解くので，試行の番号の位置に入れる
+struct LineResult
 {
-  vector<int> score(inst.numColumns, 0);
+  vector<int> weight;           // weight[t]: 試行tの最良解の重み（解が正しくなければ -1）
+  vector<SolverStats> stats;    // stats[t]: 試行tの情報
+  int lowerBound;               // 試行の中で最大の下界（求めた場合）
+  vector<int> bestCols;         // 試行の中の最良解（重みが同じなら番号の小さい試行）
+  int bestWeight;
+  int bestTrial;
+  int pending;                  // まだ終わっていない試行の数
+  std::mutex m;                 // lowerBound と最良解と pending を守る
 
-  for (int c = 0; c < inst.numColumns; c++)
-    score[c] = inst.ColEntries[c].size();
-
-  int ca;
-  SCPsolution cs(inst, k);
-
-  while (cs.num_Cover < inst.numRows)
-  {
-    ca = get_column_maxscore(inst, cs, score, rnd);
-    cs.add_column(inst, ca);
+  LineResult() : lowerBound(0), bestWeight(numeric_limits<int>::max()), bestTrial(-1), pending(0) {}
+};
 
-    // スコア更新
-    score[ca] = 0;
-    for (int r : inst.ColEntries[ca])
-    {
-      if (cs.COVERED[r] == cs.K)
-      {
-        for (int rc : inst.RowCovers[r])
-          if (!cs.SOLUTION[rc] && rc != ca) SCORE[rc]--;
-      }
-    } // end for r
-  } // End while num_Cover
 
-  return cs;
+// インスタンスのファイルの大きさ（バイト．読めなければ 0）
+double file_size(const string& file)
+{
+  struct stat st;
+  return stat(file.c_str(), &st) == 0 ? (double)st.st_size : 0.0;
 }
 
 
-
-
-SCPsolution DLL_com(SCPinstance& inst, int k, int max_iter, Rand& rnd)
+// 行 line の試行 trial の結果を res に入れる
+// 行の最後の試行なら，インスタンスがあるうちに最良解を書く
+void record_trial(SCPinstance& instance, int K, Solver& solver, int trial, int line,
+                  const RunFiles& files, LineResult& res)
 {
-  SCPsolution CS(inst, k);
-  SCPsolution CSbest(inst, k);
+  bool ok = check_solution(instance, K, solver.best_columns(), solver.best_weight());
+  int w = solver.best_weight();
+  res.weight[trial] = ok ? w : -1;
+  res.stats[trial] = solver.stats();
 
-  vector<int> Freq(inst.numColumns, 0);
-
-  CS = greedy_construction(inst, k, rnd);
-  CSbest = CS;
-
-  for (int c : CS.CS) TIMES[c] = 1;
-
-  for (int c = 0; c < inst.numColumns; c++)
+  bool last;
   {
-    SCORE[c] = 0;
-    if (CS.SOLUTION[c])
+    lock_guard<std::mutex> lock(res.m);
+    res.lowerBound = max(res.lowerBound, solver.stats().lowerBound);
+    if (ok && (w < res.bestWeight || (w == res.bestWeight && trial < res.bestTrial)))
     {
-      for (int r : inst.ColEntries[c])
-        if (CS.COVERED[r] == k) SCORE[c] -= COST[r];
+      res.bestWeight = w;
+      res.bestTrial = trial;
+      res.bestCols = solver.best_columns();
     }
+    last = (--res.pending == 0);
   }
 
-  int remove_col;
-
-  for (int iter = 1; iter <= max_iter; iter++)
-  {
-    // cout << "Iter: " << iter;
-    // cout << " " << CSbest.totalWeight << " " << CS.totalWeight << " " << CS.num_Cover << " " << CS.CS.size() << " ";
-
-
-
-    // 実行可能解が見つかったら更新
-    if (CS.num_Cover == inst.numRows) {
-      CSbest = CS;
-      remove_col = get_remove_rule(inst, CS, 0, rnd);
-
-      // cout << " Remove " << remove_col << "(" << (double)SCORE[remove_col] / inst.Weight[remove_col] << ") ";
-
-      CS.remove_column(inst, remove_col);
-      TIMES[remove_col] = iter;
-      //Freq[remove_col]++;
-
-      // update SCORE
-      remove_update_score(inst, CS, remove_col);
-
-      // update SKCC
-      SKCC[remove_col] = 0;
-      update_SKCC(inst, CS, remove_col);
-      // end update SKCC
-
-      // cout << " continue" << endl;
-      continue;
-    }
-
-    // CS が実行可能でない場合
-    // 1列削除する
-    remove_col = get_remove_rule(inst, CS, iter, rnd);
-    // cout << " Remove " << remove_col << "(" << (double)SCORE[remove_col] / inst.Weight[remove_col] << ") ";
-    CS.remove_column(inst, remove_col);
-    TIMES[remove_col] = iter;
-    remove_update_score(inst, CS, remove_col);
-    //Freq[remove_col]++;
-
-    // update SKCC
-    SKCC[remove_col] = 0;
-    update_SKCC(inst, CS, remove_col);
-    // end update SKCC
-
-    int add_col;
-    //bool brk_flag = false;
-
-    // 実行可能になるまで追加
-    while (CS.num_Cover < inst.numRows) {
-      add_col = get_add_rule(inst, CS, rnd);
-
-      if (CS.totalWeight + inst.Weight[add_col] >= CSbest.totalWeight)
-      {
-        // 追加した結果が悪い解ならやめてやり直す
-        //brk_flag = true;
-        // cout << "Add " << add_col << " Break ";
-	break;
-      }
-      else
-      {
-        // cout << "Add " << add_col << "(" << (double)SCORE[add_col] / inst.Weight[add_col] << ") ";
-        CS.add_column(inst, add_col);
-        add_update_score(inst, CS, add_col);
-
-        update_SKCC(inst, CS, add_col);
-        SKCC[add_col] = 0;
-
-        TIMES[add_col] = iter;
-        Freq[add_col]++;
-
-        // Araki: COST reset
-        // add_colを追加してK回カバーされた列のcostを1に戻してスコア再計算
-        for (int r : inst.ColEntries[add_col])
-        {
-          if (COST[r] > max_iter / 10 && CS.COVERED[r] == CS.K)
-          {
-            COST[r] = 1;
-            for (int rc : inst.RowCovers[r])
-            {
-              SCORE[rc] = compute_score(inst, CS, rc);
-            }
-          }
-        }
-      }
-
-      // update COST and SCORE
-      for (int r = 0; r < inst.numRows; r++)
-      {
-        if (CS.COVERED[r] < CS.K)
-        {
-          COST[r]++;
-          for (int rc : inst.RowCovers[r])
-          {
-            if (!CS.SOLUTION[rc]) SCORE[rc]++;
-          }
-        }
-      }
-
-      // Check
-      // for (int c = 0; c < inst.numColumns; c++) {
-      //   int sc = compute_score(inst, CS, c);
-      //   if (sc != SCORE[c]) {
-      //     printf("Col %d (%d) sc = %d, but SCORE[%d] = %d\n", c, CS.SOLUTION[c], sc, c, SCORE[c]);
-      //     exit(1);
-      //   }
-      // }
-
-    } // end while CS.num_Cover
-
-    // cout << endl;
-  } // End iter
-
+  // 他の試行はもう res を書かない
+  if (last && res.bestTrial >= 0)
+    save_best(instance, K, line, files, res.bestCols, res.bestWeight);
+}
 
-  // for (int c= 0; c < inst.numColumns; c++) {
-  //   cout << c << " ";
-  //   if (CSbest.SOLUTION[c]) cout << "+ ";
-  //   else cout << "  ";
-  //   cout << Freq[c] << endl;
-  // }
 
-  return CSbest;
+// 1つのインスタンスの試行 trial を解く（行 line のジョブ）
+void run_trial(SCPinstance& instance,
+               int K,
+               const SolverOptions& opt,
+               int trial,
+               int line,
+               const RunFiles& files,
+               LineResult& res)
+{
+  Solver solver(instance, K, opt);
+  solver.seed(trial);
+  solve_trial(solver, files.checkpoint_file(line, trial), NULL);
+  record_trial(instance, K, solver, trial, line, files, res);
 }
 
 
-
-bool check_solution(SCPinstance& inst, SCPsolution& cs)
+// 同じインスタンスの行 lines を K の昇順に解く（スイープ）の試行 trial
+// 前の K の最良解を次の K の初期解にする（Kが上がった分は貪欲法で補う）．
+// 初期解から始める K の反復回数は maxIteration * ratio にする
+// targets[i] は行 i の目標の重み（0 なら目標なし）
+void run_sweep_trial(SCPinstance& instance,
+                     const vector<int>& lines,
+                     const vector<int>& Ks,
+                     const vector<int>& maxIters,
+                     const vector<int>& targets,
+                     const SolverOptions& base,
+                     int trial,
+                     double ratio,
+                     const RunFiles& files,
+                     vector<LineResult>& Lines)
 {
-  vector<int> cov(inst.numRows, 0);
-  int tw = 0;
+  vector<int> prev;             // 前の K の最良解
 
-  for (int c : cs.CS) {
-    tw += inst.Weight[c];
-    for (int r : inst.ColEntries[c]) {
-      cov[r]++;
-    }
-  }
+  for (int i : lines)
+  {
+    SolverOptions opt = base;
+    opt.maxIteration = maxIters[i];
+    opt.targetWeight = targets[i];
+    if (!prev.empty()) opt.maxIteration = max(1, (int)(maxIters[i] * ratio));
 
-  for (int r = 0; r < inst.numRows; r++) {
-    if (cov[r] < cs.K) {
-      cout << "This is not a feasible solution." << endl;
-      return false;
-    }
-  }
+    Solver solver(instance, Ks[i], opt);
+    solver.seed(trial);
+    solve_trial(solver, files.checkpoint_file(i, trial), prev.empty() ? NULL : &prev);
 
-  if (tw != cs.totalWeight) {
-    cout << "Wrong totalWeight." << endl;
-    return false;
+    record_trial(instance, Ks[i], solver, trial, i, files, Lines[i]);
+    prev = solver.best_columns();
   }
-
-  return true;
 }
 
 
@@ -510,11 +216,66 @@ int main(int argc, char** argv)
 
   //コマンドライン引数の数が少なければ強制終了
   if (argc < 2) {
-    cout << "Usage: ./command filename" << endl;
+    cout << "Usage: ./command filename [-order none|degree|rcm]"
+         << " [-threads n] [-cache_mb m] [-sweep ratio] [-lb iters]"
+         << " [-core n] [-core_refresh iters]"
+         << " [-checkpoint prefix] [-checkpoint_every iters] [-out prefix]"
+         << " [-bms t] [-grasp alpha] [-score_threads n] [-parallel_work n]"
+         << " [-parallel_rows n] [-components n] [-lns iters] [-lns_free n]"
+         << " [-lns_tries n] [-targets minvals.txt] [-ttt file]" << endl;
     return 0;
   }
 
   char *FileName = argv[1];
+
+  // オプション
+  RenumberMode order = RENUMBER_NONE;   // 行・列の番号の付け替え方
+  int numThreads = std::thread::hardware_concurrency();   // 同時に解くバッチの行の数
+  long cacheMB = 1024;                  // インスタンスのキャッシュの上限 (MB)
+  double sweepRatio = 0;                // >0 なら同じファイルの行をKの順に解く（run_sweep）
+  SolverOptions base;                   // 行ごとに maxIteration だけ変える
+  RunFiles files;                       // チェックポイントと解の出力先
+  string targetFile;                    // 空でなければ目標の重み（minvals.txt の形式）
+  string tttFile;                       // 空でなければ試行ごとの目標への到達時間を書く
+
+  for (int a = 2; a + 1 < argc; a += 2)
+  {
+    string opt = argv[a];
+    string val = argv[a + 1];
+
+    if (opt == "-order")
+    {
+      if (val == "degree") order = RENUMBER_DEGREE;
+      else if (val == "rcm") order = RENUMBER_RCM;
+      else order = RENUMBER_NONE;
+    }
+    else if (opt == "-threads") numThreads = atoi(val.c_str());
+    else if (opt == "-cache_mb") cacheMB = atol(val.c_str());
+    else if (opt == "-sweep") sweepRatio = atof(val.c_str());
+    else if (opt == "-lb") base.lbIteration = atoi(val.c_str());
+    else if (opt == "-core") base.coreRow = atoi(val.c_str());
+    else if (opt == "-core_refresh") base.coreRefresh = atoi(val.c_str());
+    else if (opt == "-checkpoint") files.checkpoint = val;
+    else if (opt == "-checkpoint_every") base.checkpointEvery = atoi(val.c_str());
+    else if (opt == "-out") files.solution = val;
+    else if (opt == "-bms") base.bmsSample = atoi(val.c_str());
+    else if (opt == "-grasp") base.graspAlpha = atof(val.c_str());
+    else if (opt == "-score_threads") base.scoreThreads = atoi(val.c_str());
+    else if (opt == "-parallel_work") base.parallelWork = atoi(val.c_str());
+    else if (opt == "-parallel_rows") base.parallelRows = atoi(val.c_str());
+    else if (opt == "-components") base.componentThreads = atoi(val.c_str());
+    else if (opt == "-lns") base.lnsEvery = atoi(val.c_str());
+    else if (opt == "-lns_free") base.lnsFree = atoi(val.c_str());
+    else if (opt == "-lns_tries") base.lnsTries = atoi(val.c_str());
+    else if (opt == "-targets") targetFile = val;
+    else if (opt == "-ttt") tttFile = val;
+    else
+    {
+      cerr << "Unknown option: " << opt << endl;
+      return -1;
+    }
+  }
+
   ifstream ifs(FileName);
 
   if (ifs.fail())
@@ -546,50 +307,113 @@ int main(int argc, char** argv)
     maxIters.push_back(mi);                 // 繰り返しの回数
   }
 
+  // 目標の重み：最良解がこれに達したら試行をやめ，到達までの時間と反復を出す
+  vector<int> Targets(numInstanceFiles, 0);
+  if (!targetFile.empty())
+  {
+    map<pair<string, int>, int> targets;
+    if (!load_targets(targetFile, targets))
+    {
+      cerr << "Failed to open " << targetFile << endl;
+      return -1;
+    }
+    for (int i = 0; i < numInstanceFiles; i++)
+    {
+      auto it = targets.find(make_pair(instance_name(InstanceFiles[i]), Ks[i]));
+      if (it != targets.end()) Targets[i] = it->second;
+    }
+  }
+
 
   // SCPのインスタンスを読み込む
   // char *FileName = argv[1];
   // FILE *SourceFile = fopen(FileName,"r");
 
-  for (int i = 0; i < numInstanceFiles; i++)
+  // 同じファイルの行（Kが違うだけ）は読み込んだインスタンスを共有する．
+  // ジョブは (行, 試行)（スイープなら (同じファイルの行のまとまり, 試行)）で，
+  // 手間を ファイルの大きさ x 反復回数 と見積もり（非ゼロ要素の数にほぼ比例し，
+  // 読み込まずに分かる），大きいものから numThreads 個のスレッドに分ける（SCPjobPool）．
+  // インスタンスはジョブの中で読み込む．結果は行と試行の位置に入れるので，出力はファイルの順
+  vector<vector<int> > Tasks;
+  if (sweepRatio > 0)
   {
-    string instance_file = InstanceFiles[i];
-    int K = Ks[i];
-    int maxIteration = maxIters[i];
-
-    SCPinstance instance(instance_file);
-
-    vector<int> result;
-
-
-    for (int trial = 0; trial < numTrial; trial++)
+    map<string, int> taskOf;
+    for (int i = 0; i < numInstanceFiles; i++)
     {
-      // initialize
-      for (int i = 0; i < instance.numColumns; i++) {
-        SKCC.push_back(1);
-        SCORE.push_back(0);
-        TIMES.push_back(0);
-      }
-      for (int i = 0; i < instance.numRows; i++) {
-        COST.push_back(1);
+      if (taskOf.count(InstanceFiles[i]) == 0)
+      {
+        taskOf[InstanceFiles[i]] = Tasks.size();
+        Tasks.push_back(vector<int>());
       }
+      Tasks[taskOf[InstanceFiles[i]]].push_back(i);
+    }
+    for (vector<int>& lines : Tasks)
+      stable_sort(lines.begin(), lines.end(), [&](int a, int b) { return Ks[a] < Ks[b]; });
+  }
+  else
+  {
+    for (int i = 0; i < numInstanceFiles; i++) Tasks.push_back(vector<int>(1, i));
+  }
 
-      Rand rnd;
-      //int seed = 0;
-      rnd.seed(trial);
-      // End Initialize;
+  SCPinstanceCache cache((std::size_t)cacheMB << 20, order);
+  vector<LineResult> Lines(numInstanceFiles);
+  for (LineResult& res : Lines)
+  {
+    res.weight.assign(numTrial, -1);
+    res.stats.assign(numTrial, SolverStats());
+    res.pending = numTrial;
+  }
 
-      SCPsolution CSbest(instance, K);
+  // 手間の見積もり
+  int numTasks = Tasks.size();
+  vector<double> taskCost(numTasks, 0);
+  for (int t = 0; t < numTasks; t++)
+  {
+    double size = max(1.0, file_size(InstanceFiles[Tasks[t][0]]));
+    for (size_t p = 0; p < Tasks[t].size(); p++)
+      taskCost[t] += size * maxIters[Tasks[t][p]] * (p > 0 ? sweepRatio : 1.0);
+  }
 
-      CSbest = DLL_com(instance, K, maxIteration, rnd);
+  vector<double> cost(numTasks * numTrial);
+  for (int j = 0; j < numTasks * numTrial; j++) cost[j] = taskCost[j / numTrial];
 
-      if (check_solution(instance, CSbest)) {
-        //CSbest.print_solution();
-        result.push_back(CSbest.totalWeight);
-      }
-    } // End trial
+  if (numThreads < 1) numThreads = 1;
+  SCPjobPool pool(numThreads);
+  pool.run(cost, [&](int j) {
+    const vector<int>& lines = Tasks[j / numTrial];
+    int trial = j % numTrial;
+    int i = lines[0];
+
+    std::shared_ptr<SCPinstance> instance = cache.get(InstanceFiles[i]);
+
+    if (sweepRatio > 0)
+      run_sweep_trial(*instance, lines, Ks, maxIters, Targets, base, trial, sweepRatio,
+                      files, Lines);
+    else
+    {
+      SolverOptions opt = base;
+      opt.maxIteration = maxIters[i];
+      opt.targetWeight = Targets[i];
+      run_trial(*instance, Ks[i], opt, trial, i, files, Lines[i]);
+    }
+  });
 
-    Results.push_back(result);
+  // 正しい解の試行の結果を試行の順に並べる（TrialIds は元の試行の番号）
+  Results.resize(numInstanceFiles);
+  vector<vector<SolverStats> > Stats(numInstanceFiles);
+  vector<vector<int> > TrialIds(numInstanceFiles);
+  vector<int> LowerBounds(numInstanceFiles, 0);
+  for (int i = 0; i < numInstanceFiles; i++)
+  {
+    LineResult& res = Lines[i];
+    for (int t = 0; t < numTrial; t++)
+    {
+      if (res.weight[t] < 0) continue;
+      Results[i].push_back(res.weight[t]);
+      Stats[i].push_back(res.stats[t]);
+      TrialIds[i].push_back(t);
+    }
+    LowerBounds[i] = res.lowerBound;
   }
 
   // 出力
@@ -601,18 +425,61 @@ int main(int argc, char** argv)
 
     cout << instance_file << "," << K << "," << maxIteration << ",";
 
-    int Best_totalWeight = numeric_limits<int>::max();
+    // 平均は正しい解の試行だけでとる（なければ最良も平均も 0）
+    int n = Results[i].size();
+    int Best_totalWeight = n > 0 ? numeric_limits<int>::max() : 0;
     int Sum_totalWeight = 0;
 
-    for (int t = 0; t < numTrial; t++)
+    for (int t = 0; t < n; t++)
     {
       if (Best_totalWeight > Results[i][t]) Best_totalWeight = Results[i][t];
       Sum_totalWeight += Results[i][t];
       cout << Results[i][t] << ",";
     }
     cout << Best_totalWeight << ","
-         << (double)Sum_totalWeight / numTrial
-         << endl;
+         << (n > 0 ? (double)Sum_totalWeight / n : 0.0);
+
+    // 下界を求めたときは下界とギャップ（最良解との差の割合）を追加
+    if (base.lbIteration > 0)
+    {
+      cout << "," << LowerBounds[i] << ","
+           << (n > 0 ? (double)(Best_totalWeight - LowerBounds[i]) / Best_totalWeight : 0.0);
+    }
+
+    // 目標を与えたときは目標，達した試行の数，達した試行の平均の到達時間（秒）と反復回数を追加
+    if (!targetFile.empty())
+    {
+      int hits = 0;
+      double sec = 0, it = 0;
+      for (const SolverStats& st : Stats[i])
+      {
+        if (!st.targetReached) continue;
+        hits++;
+        sec += st.targetSeconds;
+        it += st.targetIteration;
+      }
+      cout << "," << Targets[i] << "," << hits << ","
+           << (hits > 0 ? sec / hits : 0) << "," << (hits > 0 ? it / hits : 0);
+    }
+    cout << endl;
+  }
+
+  // 試行ごとの到達時間（time-to-target の分布を描くため）
+  if (!tttFile.empty())
+  {
+    ofstream out(tttFile);
+    out << "instance,K,trial,target,weight,reached,iteration,seconds" << endl;
+    for (int i = 0; i < numInstanceFiles; i++)
+    {
+      for (size_t t = 0; t < Stats[i].size(); t++)
+      {
+        const SolverStats& st = Stats[i][t];
+        out << InstanceFiles[i] << "," << Ks[i] << "," << TrialIds[i][t] << "," << Targets[i] << ","
+            << Results[i][t] << "," << (st.targetReached ? 1 : 0) << ","
+            << st.targetIteration << "," << st.targetSeconds << endl;
+      }
+    }
+    if (!out) cerr << "Failed to write " << tttFile << endl;
   }
 
 